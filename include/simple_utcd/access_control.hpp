@@ -0,0 +1,86 @@
+/*
+ * includes/simple_utcd/access_control.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct sockaddr;
+struct sockaddr_storage;
+
+namespace simple_utcd {
+
+/**
+ * @brief Client ACL compiled into binary prefix tries
+ *
+ * Rules are single addresses or CIDR blocks ("10.0.0.0/8", "2001:db8::/32").
+ * IPv4 and IPv6 rules live in separate tries; an IPv4-mapped IPv6 peer is
+ * looked up as IPv4. A lookup walks at most 32 or 128 nodes regardless of
+ * how many rules were loaded.
+ *
+ * Semantics match the configuration: a denied match always loses, and when
+ * query restriction is on with a non-empty allow list the peer has to match
+ * one of its entries.
+ */
+class AccessControl {
+public:
+    AccessControl(const std::vector<std::string>& allowed_clients,
+                  const std::vector<std::string>& denied_clients,
+                  bool restrict_queries);
+
+    bool is_allowed(const struct sockaddr_storage& address) const;
+    bool is_allowed(const struct sockaddr* address) const;
+
+    size_t rule_count() const { return rule_count_; }
+
+    /**
+     * @brief Whether any peer can be refused, including by an allow list with no valid entries
+     */
+    bool is_filtering() const { return rule_count_ > 0 || check_allow_list_; }
+
+    /**
+     * @brief Entries that could not be parsed as an address or CIDR block
+     */
+    const std::vector<std::string>& invalid_rules() const { return invalid_rules_; }
+
+private:
+    static constexpr uint8_t RULE_ALLOW = 1;
+    static constexpr uint8_t RULE_DENY = 2;
+
+    // Children are indices into the node array; 0 doubles as "none" since it is the root
+    struct Node {
+        uint32_t child[2] = {0, 0};
+        uint8_t rules = 0;
+    };
+
+    std::vector<Node> v4_;
+    std::vector<Node> v6_;
+    bool check_allow_list_;
+    size_t rule_count_;
+    std::vector<std::string> invalid_rules_;
+
+    bool add_rule(const std::string& rule, uint8_t kind);
+    static void insert(std::vector<Node>& trie, const uint8_t* bytes, int prefix_length, uint8_t kind);
+    static uint8_t match(const std::vector<Node>& trie, const uint8_t* bytes, int bits);
+    bool check(const uint8_t* bytes, int bits) const;
+};
+
+} // namespace simple_utcd
@@ -0,0 +1,72 @@
+/*
+ * includes/simple_utcd/admin_server.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+namespace simple_utcd {
+
+class UTCServer;
+class UTCConfig;
+class Logger;
+
+/**
+ * @brief Minimal HTTP/1.1 admin listener on its own thread and port
+ *
+ * Serves GET /metrics (Prometheus text format) and GET /healthz. Requests
+ * are handled one at a time and every response closes the connection.
+ * Rendering only reads atomics and snapshots, so scraping never blocks
+ * or slows the serving threads.
+ */
+class AdminServer {
+public:
+    AdminServer(UTCServer* server, UTCConfig* config, Logger* logger);
+    ~AdminServer();
+
+    AdminServer(const AdminServer&) = delete;
+    AdminServer& operator=(const AdminServer&) = delete;
+
+    bool start();
+    void stop();
+    bool is_running() const { return running_; }
+
+    std::string render_metrics() const;
+
+    /**
+     * @brief Health report body
+     * @return true if the TCP listener and the time ticker are both alive
+     */
+    bool render_health(std::string& body) const;
+
+private:
+    UTCServer* server_;
+    UTCConfig* config_;
+    Logger* logger_;
+
+    std::atomic<bool> running_;
+    std::thread thread_;
+    int listen_fd_;
+
+    void thread_main();
+    void handle_client(int client_fd);
+};
+
+} // namespace simple_utcd
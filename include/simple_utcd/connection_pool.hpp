@@ -0,0 +1,89 @@
+/*
+ * includes/simple_utcd/connection_pool.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include "utc_connection.hpp"
+
+namespace simple_utcd {
+
+class ConnectionPool;
+
+/**
+ * @brief Returns a connection to the pool it came from, or deletes it
+ */
+struct ConnectionDeleter {
+    ConnectionPool* pool = nullptr;
+    void operator()(UTCConnection* connection) const;
+};
+
+using ConnectionPtr = std::unique_ptr<UTCConnection, ConnectionDeleter>;
+
+/**
+ * @brief Fixed slab of UTCConnection records with an intrusive free list
+ *
+ * The slab is allocated once; acquire() constructs in place and release()
+ * destroys in place, so steady-state accept traffic never reaches the heap.
+ * When the slab is exhausted connections fall back to new/delete and are
+ * counted. Event loop workers each own an unlocked pool; the threaded
+ * backend shares one with locking enabled.
+ */
+class ConnectionPool {
+public:
+    // Every connection must be released before the pool goes away
+    ConnectionPool(size_t capacity, bool thread_safe);
+
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    ConnectionPtr acquire(int socket_fd, const struct sockaddr_storage& peer,
+                          UTCConfig* config, Logger* logger);
+    void release(UTCConnection* connection);
+
+    /**
+     * @brief Connection from the heap; used when pooling is disabled
+     */
+    static ConnectionPtr make_unpooled(int socket_fd, const struct sockaddr_storage& peer,
+                                       UTCConfig* config, Logger* logger);
+
+    size_t capacity() const { return capacity_; }
+    size_t in_use() const { return in_use_; }
+    uint64_t get_heap_fallbacks() const { return heap_fallbacks_; }
+
+private:
+    union Slot {
+        Slot* next_free;
+        alignas(UTCConnection) unsigned char storage[sizeof(UTCConnection)];
+    };
+
+    size_t capacity_;
+    bool thread_safe_;
+    std::unique_ptr<Slot[]> slots_;
+    Slot* free_list_;
+    size_t in_use_;
+    uint64_t heap_fallbacks_;
+    std::mutex mutex_;
+
+    bool owns(const UTCConnection* connection) const;
+};
+
+} // namespace simple_utcd
@@ -19,6 +19,8 @@
 #pragma once
 
 #include <string>
+#include <array>
+#include <atomic>
 #include <exception>
 #include <memory>
 #include <vector>
@@ -150,7 +152,7 @@ public:
 private:
     bool logging_enabled_;
     ErrorSeverity min_log_level_;
-    std::vector<size_t> error_counts_;
+    std::array<std::atomic<size_t>, 4> error_counts_;  // read by the admin endpoint while serving
 
     void log_error(const ErrorContext& context, const std::exception* exception);
     std::string severity_to_string(ErrorSeverity severity) const;
@@ -0,0 +1,78 @@
+/*
+ * includes/simple_utcd/event_loop.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace simple_utcd {
+
+/**
+ * @brief Edge-triggered readiness loop owned by a single worker thread
+ *
+ * Wraps epoll on Linux. On other platforms is_supported() returns false
+ * and the server falls back to the threaded accept path.
+ */
+class EventLoop {
+public:
+    enum EventFlags : uint32_t {
+        EVENT_READABLE = 1u << 0,
+        EVENT_WRITABLE = 1u << 1,
+        EVENT_ERROR    = 1u << 2,
+        EVENT_HANGUP   = 1u << 3
+    };
+
+    explicit EventLoop(int max_events);
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    static bool is_supported();
+    bool is_valid() const { return epoll_fd_ >= 0; }
+
+    /**
+     * @brief Register a descriptor for edge-triggered notification
+     * @param exclusive Wake only one of the loops sharing this descriptor
+     */
+    bool add(int fd, uint32_t events, void* data, bool exclusive = false);
+    bool modify(int fd, uint32_t events, void* data);
+    bool remove(int fd);
+
+    /**
+     * @brief Wait for readiness
+     * @return Number of ready events, 0 on timeout or wakeup, -1 on error
+     */
+    int wait(int timeout_ms);
+    void* event_data(int index) const;
+    uint32_t event_flags(int index) const;
+
+    /**
+     * @brief Interrupt a concurrent wait() from another thread
+     */
+    void wakeup();
+
+private:
+    int epoll_fd_;
+    int wakeup_fd_;
+    int max_events_;
+    std::vector<uint8_t> events_;  // storage for native event records
+};
+
+} // namespace simple_utcd
@@ -0,0 +1,106 @@
+/*
+ * includes/simple_utcd/latency_histogram.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace simple_utcd {
+
+enum class LatencyMetric : size_t {
+    ACCEPT_TO_SEND = 0,  // accept() returned until the reply was handed to the kernel
+    SEND_SYSCALL,        // encoding plus send()
+    QUEUE_WAIT,          // accepted until a worker picked the connection up
+    NTP_RESIDENCE,       // NTP request stamped in by the kernel until its reply was stamped out
+    COUNT
+};
+
+struct LatencySummary {
+    uint64_t count = 0;
+    uint64_t p50 = 0;   // nanoseconds
+    uint64_t p99 = 0;
+    uint64_t p999 = 0;
+    uint64_t max = 0;
+    uint64_t sum = 0;   // of every recorded value, for rate(sum) / rate(count)
+};
+
+/**
+ * @brief Log-linear latency histogram in nanoseconds
+ *
+ * HDR-style bucketing: values below 16 ns are exact, and every power of
+ * two above that is split into 16 linear sub-buckets, so a reported value
+ * is within about 6% of the true one. Values past ~2^40 ns (18 minutes)
+ * land in the last bucket.
+ *
+ * record() is for a single writer thread and compiles to plain loads and
+ * stores; any thread may merge a live histogram into its own copy.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 4;
+    static constexpr size_t SUB_BUCKETS = size_t(1) << SUB_BUCKET_BITS;
+    static constexpr size_t BUCKETS = 38 * SUB_BUCKETS;
+
+    LatencyHistogram();
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(uint64_t nanoseconds) {
+        size_t bucket = bucket_index(nanoseconds);
+        counts_[bucket].store(counts_[bucket].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        sum_.store(sum_.load(std::memory_order_relaxed) + nanoseconds, std::memory_order_relaxed);
+        if (nanoseconds > max_.load(std::memory_order_relaxed)) {
+            max_.store(nanoseconds, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Add @p other's counts into this histogram
+     */
+    void merge_from(const LatencyHistogram& other);
+    void reset();
+
+    uint64_t count() const;
+    uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+    uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Upper bound of the bucket holding quantile @p q (0..1)
+     */
+    uint64_t percentile(double q) const;
+    LatencySummary summary() const;
+
+    static size_t bucket_index(uint64_t value);
+    static uint64_t bucket_upper_bound(size_t index);
+
+    static uint64_t now_ns();
+
+private:
+    std::atomic<uint64_t> counts_[BUCKETS];
+    std::atomic<uint64_t> max_;
+    std::atomic<uint64_t> sum_;
+};
+
+// One histogram per metric, owned by a single serving thread
+using LatencySet = std::array<LatencyHistogram, static_cast<size_t>(LatencyMetric::COUNT)>;
+
+} // namespace simple_utcd
@@ -0,0 +1,139 @@
+/*
+ * includes/simple_utcd/log_format.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <charconv>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+struct sockaddr_storage;
+
+namespace simple_utcd {
+
+/**
+ * @brief Reusable output buffer for "{}" log formatting
+ *
+ * Lines up to INLINE_SIZE bytes stay in the inline array; longer ones
+ * spill into a string whose capacity is kept for the next line.
+ */
+class LogBuffer {
+public:
+    static constexpr size_t INLINE_SIZE = 1024;
+
+    void clear() {
+        size_ = 0;
+        heap_.clear();
+    }
+
+    void append(const char* data, size_t length) {
+        if (heap_.empty() && size_ + length <= INLINE_SIZE) {
+            memcpy(inline_ + size_, data, length);
+            size_ += length;
+            return;
+        }
+        if (heap_.empty()) {
+            heap_.assign(inline_, size_);
+        }
+        heap_.append(data, length);
+    }
+
+    const char* data() const { return heap_.empty() ? inline_ : heap_.data(); }
+    size_t size() const { return heap_.empty() ? size_ : heap_.size(); }
+
+private:
+    char inline_[INLINE_SIZE];
+    size_t size_ = 0;
+    std::string heap_;
+};
+
+// Argument rendering; add an overload here to make a type loggable
+inline void append_value(LogBuffer& out, std::string_view value) {
+    out.append(value.data(), value.size());
+}
+
+inline void append_value(LogBuffer& out, const std::string& value) {
+    out.append(value.data(), value.size());
+}
+
+inline void append_value(LogBuffer& out, const char* value) {
+    append_value(out, std::string_view(value ? value : "(null)"));
+}
+
+inline void append_value(LogBuffer& out, char value) {
+    out.append(&value, 1);
+}
+
+inline void append_value(LogBuffer& out, bool value) {
+    append_value(out, std::string_view(value ? "true" : "false"));
+}
+
+template<typename T>
+typename std::enable_if<std::is_integral<T>::value>::type
+append_value(LogBuffer& out, T value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, static_cast<size_t>(result.ptr - digits));
+}
+
+template<typename T>
+typename std::enable_if<std::is_floating_point<T>::value>::type
+append_value(LogBuffer& out, T value) {
+    char digits[32];
+    int length = snprintf(digits, sizeof(digits), "%g", static_cast<double>(value));
+    if (length > 0) {
+        out.append(digits, static_cast<size_t>(length));
+    }
+}
+
+template<typename T>
+void append_value(LogBuffer& out, const std::atomic<T>& value) {
+    append_value(out, value.load(std::memory_order_relaxed));
+}
+
+// Peer addresses are rendered with inet_ntop only when the line is emitted
+void append_value(LogBuffer& out, const struct sockaddr_storage& address);
+
+inline void format_to(LogBuffer& out, const char* format) {
+    append_value(out, format);
+}
+
+/**
+ * @brief Replace each "{}" in @p format with the next argument
+ *
+ * Surplus placeholders are copied literally; surplus arguments are ignored.
+ */
+template<typename First, typename... Rest>
+void format_to(LogBuffer& out, const char* format, const First& first, const Rest&... rest) {
+    const char* placeholder = strstr(format, "{}");
+    if (!placeholder) {
+        append_value(out, format);
+        return;
+    }
+
+    out.append(format, static_cast<size_t>(placeholder - format));
+    append_value(out, first);
+    format_to(out, placeholder + 2, rest...);
+}
+
+} // namespace simple_utcd
@@ -22,7 +22,12 @@
 #include <memory>
 #include <fstream>
 #include <mutex>
+#include <atomic>
+#include <thread>
+#include <cstdint>
 #include <type_traits>
+#include "mpmc_queue.hpp"
+#include "log_format.hpp"
 
 namespace simple_utcd {
 
@@ -33,60 +38,123 @@ enum class LogLevel {
     ERROR = 3
 };
 
+enum class LogOverflowPolicy {
+    DROP = 0,   // discard the record and count it
+    BLOCK = 1   // wait for the writer to make room
+};
+
 class Logger {
 public:
     Logger();
     ~Logger();
 
     void set_level(LogLevel level);
+    bool should_log(LogLevel level) const {
+        return level >= current_level_.load(std::memory_order_relaxed);
+    }
     void set_log_file(const std::string& filename);
     void enable_console(bool enable);
     void enable_syslog(bool enable);
 
+    /**
+     * @brief Hand formatted records to a background writer thread
+     * @param queue_size Records the ring can hold before the overflow policy applies
+     * @param flush_interval_ms Longest time a record waits before being written
+     * @param flush_bytes Write out early once this much output is pending
+     *
+     * Call during startup, before other threads log.
+     */
+    void enable_async(size_t queue_size, int flush_interval_ms, size_t flush_bytes,
+                      LogOverflowPolicy policy);
+
+    /**
+     * @brief Drain pending records and return to synchronous writes
+     */
+    void disable_async();
+
+    bool is_async() const { return async_.load(std::memory_order_relaxed); }
+    uint64_t get_dropped_records() const { return dropped_records_.load(std::memory_order_relaxed); }
+
+    static LogLevel parse_level(const std::string& level);
+    static LogOverflowPolicy parse_overflow_policy(const std::string& policy);
+
     void debug(const std::string& message);
     void info(const std::string& message);
     void warn(const std::string& message);
     void error(const std::string& message);
 
+    // "{}" formatting; arguments are only rendered if the level is enabled
     template<typename... Args>
-    void debug(const std::string& format, Args&&... args) {
-        log(LogLevel::DEBUG, format, std::forward<Args>(args)...);
+    void debug(const char* format, const Args&... args) {
+        log(LogLevel::DEBUG, format, args...);
     }
 
     template<typename... Args>
-    void info(const std::string& format, Args&&... args) {
-        log(LogLevel::INFO, format, std::forward<Args>(args)...);
+    void info(const char* format, const Args&... args) {
+        log(LogLevel::INFO, format, args...);
     }
 
     template<typename... Args>
-    void warn(const std::string& format, Args&&... args) {
-        log(LogLevel::WARN, format, std::forward<Args>(args)...);
+    void warn(const char* format, const Args&... args) {
+        log(LogLevel::WARN, format, args...);
     }
 
     template<typename... Args>
-    void error(const std::string& format, Args&&... args) {
-        log(LogLevel::ERROR, format, std::forward<Args>(args)...);
+    void error(const char* format, const Args&... args) {
+        log(LogLevel::ERROR, format, args...);
     }
 
 private:
-    LogLevel current_level_;
+    // Fixed-size preformatted line; longer lines are truncated
+    static constexpr size_t RECORD_SIZE = 512;
+    struct LogRecord {
+        LogLevel level;
+        uint16_t length;
+        uint16_t message_offset;  // start of the message after the prefix, for syslog
+        char text[RECORD_SIZE];
+    };
+
+    std::atomic<LogLevel> current_level_;
     std::string log_file_;
     std::unique_ptr<std::ofstream> file_stream_;
     bool console_enabled_;
     bool syslog_enabled_;
     std::mutex log_mutex_;
 
+    // Asynchronous mode
+    std::atomic<bool> async_;
+    std::atomic<bool> writer_running_;
+    std::unique_ptr<MPMCQueue<LogRecord>> queue_;
+    std::thread writer_thread_;
+    int flush_interval_ms_;
+    size_t flush_bytes_;
+    LogOverflowPolicy overflow_policy_;
+    std::atomic<uint64_t> dropped_records_;
+
     void log(LogLevel level, const std::string& message);
+    void write(LogLevel level, const char* message, size_t length);
+    void format_record(LogRecord& record, LogLevel level, const char* message, size_t length);
+    void enqueue(LogLevel level, const char* message, size_t length);
+    void writer_main();
+    static LogBuffer& thread_buffer();
 
-        template<typename... Args>
-    void log(LogLevel level, const std::string& format, Args&&... args) {
-        // For now, just log the format string without formatting
-        // TODO: Implement proper string formatting
-        log(level, format);
+    template<typename... Args>
+    void log(LogLevel level, const char* format, const Args&... args) {
+        // A disabled level costs this one comparison
+        if (!should_log(level)) {
+            return;
+        }
+
+        LogBuffer& buffer = thread_buffer();
+        buffer.clear();
+        format_to(buffer, format, args...);
+        write(level, buffer.data(), buffer.size());
     }
 
     std::string level_to_string(LogLevel level);
     std::string get_timestamp();
+    static size_t format_timestamp(char* out, size_t size);
+    static size_t format_prefix(char* out, size_t size, LogLevel level);
 };
 
 } // namespace simple_utcd
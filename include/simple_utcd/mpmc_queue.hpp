@@ -0,0 +1,180 @@
+/*
+ * includes/simple_utcd/mpmc_queue.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace simple_utcd {
+
+/**
+ * @brief Bounded lock-free multi-producer/multi-consumer ring
+ *
+ * Each cell carries a sequence number that tells producers and consumers
+ * whether it is free or filled for their lap, so push and pop only contend
+ * on a single compare-exchange. Consumers that find the ring empty can
+ * block in pop_wait(); producers only touch the mutex when someone is
+ * actually parked.
+ */
+template<typename T>
+class MPMCQueue {
+public:
+    explicit MPMCQueue(size_t capacity)
+        : capacity_(round_up(capacity))
+        , mask_(capacity_ - 1)
+        , cells_(new Cell[capacity_])
+        , head_(0)
+        , tail_(0)
+        , waiters_(0)
+    {
+        for (size_t i = 0; i < capacity_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MPMCQueue(const MPMCQueue&) = delete;
+    MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+    size_t capacity() const { return capacity_; }
+
+    /**
+     * @brief Enqueue without blocking
+     * @return false if the ring is full; @p value is left untouched
+     */
+    bool try_push(T& value) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->value = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+
+        // Pairs with the fence in pop_wait() so a parked consumer is never missed
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(wait_mutex_);
+            wait_cv_.notify_one();
+        }
+        return true;
+    }
+
+    /**
+     * @brief Dequeue without blocking
+     * @return false if the ring is empty
+     */
+    bool try_pop(T& value) {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+
+        value = std::move(cell->value);
+        cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Dequeue, parking the caller for up to @p timeout while empty
+     */
+    template<typename Rep, typename Period>
+    bool pop_wait(T& value, const std::chrono::duration<Rep, Period>& timeout) {
+        if (try_pop(value)) {
+            return true;
+        }
+
+        std::unique_lock<std::mutex> lock(wait_mutex_);
+        waiters_.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        bool popped = try_pop(value);
+        if (!popped) {
+            wait_cv_.wait_for(lock, timeout);
+            popped = try_pop(value);
+        }
+
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+        return popped;
+    }
+
+    /**
+     * @brief Wake every parked consumer, e.g. on shutdown
+     */
+    void notify_all() {
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        wait_cv_.notify_all();
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    static size_t round_up(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+
+    // Producers and consumers each get their own cache line
+    alignas(64) std::atomic<size_t> head_;
+    alignas(64) std::atomic<size_t> tail_;
+    alignas(64) std::atomic<int> waiters_;
+    std::mutex wait_mutex_;
+    std::condition_variable wait_cv_;
+};
+
+} // namespace simple_utcd
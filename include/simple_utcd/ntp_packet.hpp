@@ -0,0 +1,93 @@
+/*
+ * includes/simple_utcd/ntp_packet.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace simple_utcd {
+
+/**
+ * @brief NTPv4 (RFC 5905) header layout and timestamp arithmetic
+ *
+ * Timestamps are handled as signed nanoseconds since the Unix epoch and
+ * converted to the 64-bit NTP format only at the wire.
+ */
+class NTPPacket {
+public:
+    static constexpr size_t PACKET_SIZE = 48;  // header without extension fields or MAC
+
+    // Field offsets within the header
+    static constexpr size_t OFFSET_FLAGS = 0;  // leap (2 bits), version (3), mode (3)
+    static constexpr size_t OFFSET_STRATUM = 1;
+    static constexpr size_t OFFSET_POLL = 2;
+    static constexpr size_t OFFSET_PRECISION = 3;
+    static constexpr size_t OFFSET_ROOT_DELAY = 4;
+    static constexpr size_t OFFSET_ROOT_DISPERSION = 8;
+    static constexpr size_t OFFSET_REFERENCE_ID = 12;
+    static constexpr size_t OFFSET_REFERENCE_TIME = 16;
+    static constexpr size_t OFFSET_ORIGIN_TIME = 24;
+    static constexpr size_t OFFSET_RECEIVE_TIME = 32;
+    static constexpr size_t OFFSET_TRANSMIT_TIME = 40;
+
+    static constexpr uint8_t MODE_CLIENT = 3;
+    static constexpr uint8_t MODE_SERVER = 4;
+    static constexpr uint8_t LEAP_NONE = 0;
+    static constexpr uint8_t LEAP_ALARM = 3;  // clock not synchronized
+
+    // Seconds from 1900 (NTP and RFC 868 epoch) to 1970
+    static constexpr int64_t EPOCH_DELTA = 2208988800LL;
+
+    static constexpr uint8_t make_flags(uint8_t leap, uint8_t version, uint8_t mode) {
+        return static_cast<uint8_t>((leap << 6) | ((version & 0x7) << 3) | (mode & 0x7));
+    }
+    static constexpr uint8_t leap(uint8_t flags) { return flags >> 6; }
+    static constexpr uint8_t version(uint8_t flags) { return (flags >> 3) & 0x7; }
+    static constexpr uint8_t mode(uint8_t flags) { return flags & 0x7; }
+
+    static constexpr uint64_t load_be64(const uint8_t* data) {
+        return (static_cast<uint64_t>(data[0]) << 56) | (static_cast<uint64_t>(data[1]) << 48) |
+               (static_cast<uint64_t>(data[2]) << 40) | (static_cast<uint64_t>(data[3]) << 32) |
+               (static_cast<uint64_t>(data[4]) << 24) | (static_cast<uint64_t>(data[5]) << 16) |
+               (static_cast<uint64_t>(data[6]) << 8) | static_cast<uint64_t>(data[7]);
+    }
+
+    static constexpr void store_be64(uint64_t value, uint8_t* out) {
+        for (int i = 7; i >= 0; --i) {
+            out[i] = static_cast<uint8_t>(value & 0xFF);
+            value >>= 8;
+        }
+    }
+
+    /**
+     * @brief 32-bit seconds since 1900 to Unix seconds
+     *
+     * Values below 2^31 are taken to be past the 2036 era rollover.
+     */
+    static int64_t era_seconds_to_unix(uint32_t seconds);
+
+    static uint64_t to_timestamp(int64_t unix_ns);
+    static int64_t from_timestamp(uint64_t timestamp);
+
+    // NTP short format: 16.16 fixed-point seconds
+    static uint32_t to_short(int64_t nanoseconds);
+    static int64_t from_short(uint32_t value);
+};
+
+} // namespace simple_utcd
@@ -0,0 +1,80 @@
+/*
+ * includes/simple_utcd/ntp_responder.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "ntp_packet.hpp"
+
+namespace simple_utcd {
+
+class UTCConfig;
+class TimeSynchronizer;
+
+/**
+ * @brief Builds SNTP/NTPv4 server replies (RFC 4330 / RFC 5905)
+ *
+ * Replies are written over the request buffer. Everything except the
+ * client-specific fields is prepared once per batch by header(), so a
+ * reply costs a 24-byte copy and two timestamp stores; the transmit time
+ * is patched in afterwards, right before the batch is sent. The responder
+ * itself is immutable and shared by every serving thread.
+ */
+class NTPResponder {
+public:
+    // Bytes 0-23 of the reply: flags through reference timestamp
+    using Header = std::array<uint8_t, NTPPacket::OFFSET_ORIGIN_TIME>;
+
+    /**
+     * @param synchronizer upstream state for leap, root distance and reference
+     *        time; null when serving the local clock
+     */
+    NTPResponder(const UTCConfig* config, const TimeSynchronizer* synchronizer);
+
+    /**
+     * @brief Shared part of the replies for one batch
+     * @param now_ns current served time, used as the reference time without a synchronizer
+     */
+    Header header(int64_t now_ns) const;
+
+    /**
+     * @brief Turn a client request into a reply in place
+     * @param receive_ns served time the request arrived
+     * @return false if the datagram is not an NTP client request; it gets no reply
+     */
+    bool respond(const Header& header, uint8_t* packet, size_t size, int64_t receive_ns) const;
+
+    /**
+     * @brief Stamp a built reply just before it is handed to the kernel
+     */
+    static void set_transmit_time(uint8_t* packet, int64_t transmit_ns) {
+        NTPPacket::store_be64(NTPPacket::to_timestamp(transmit_ns), packet + NTPPacket::OFFSET_TRANSMIT_TIME);
+    }
+
+    // log2 seconds; about a microsecond, what a user-space stamp is good for
+    static constexpr int8_t PRECISION = -20;
+
+private:
+    const TimeSynchronizer* synchronizer_;
+    uint8_t stratum_;
+    std::array<uint8_t, 4> reference_id_;
+};
+
+} // namespace simple_utcd
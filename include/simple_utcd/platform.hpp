@@ -19,9 +19,26 @@
 #pragma once
 
 #include <string>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+struct sockaddr_storage;
+struct msghdr;
 
 namespace simple_utcd {
 
+/**
+ * @brief Host-wide TCP socket table, as the kernel reports it
+ */
+struct TcpSocketStats {
+    uint64_t in_use = 0;
+    uint64_t orphaned = 0;      // closed by their process, still finishing the handshake
+    uint64_t time_wait = 0;
+    uint64_t allocated = 0;
+    uint64_t memory_bytes = 0;  // held by TCP socket buffers
+};
+
 class Platform {
 public:
     // Platform detection
@@ -34,9 +51,30 @@ public:
     static int create_socket(int domain, int type, int protocol);
     static int close_socket(int socket_fd);
     static bool set_socket_option(int socket_fd, int level, int option, const void* value, int value_size);
-    static bool bind_socket(int socket_fd, const std::string& address, int port);
+    // Wildcard addresses ("", "0.0.0.0", "::") resolve to the IPv6 wildcard when allow_ipv6 is set
+    static bool resolve_address(const std::string& address, int port, bool allow_ipv6,
+                                struct sockaddr_storage& addr, size_t& length);
+    static bool bind_socket(int socket_fd, const struct sockaddr_storage& addr, size_t length);
+    // Let an IPv6 socket also take IPv4 traffic, as IPv4-mapped addresses
+    static bool set_dual_stack(int socket_fd);
     static bool listen_socket(int socket_fd, int backlog);
-    static int accept_connection(int socket_fd, std::string& client_address);
+    static int accept_connection(int socket_fd, struct sockaddr_storage* client_addr);
+    static int accept_nonblocking(int socket_fd, struct sockaddr_storage* client_addr);
+    static bool set_nonblocking(int socket_fd);
+    static bool would_block();
+    static std::string address_to_string(const struct sockaddr_storage& addr);
+
+    // From /proc/net/sockstat; false where the kernel does not provide it
+    static bool read_tcp_socket_stats(TcpSocketStats& stats);
+
+    // Kernel packet timestamps, software clock (SO_TIMESTAMPING, or SO_TIMESTAMPNS for receive only)
+    static bool enable_timestamping(int socket_fd, bool receive, bool transmit);
+    // Receive stamp from a message's ancillary data in Unix nanoseconds, 0 if none
+    static int64_t receive_timestamp_ns(const struct msghdr& message);
+    // Drain transmit stamps from the error queue; the callback gets each looped-back
+    // packet (headers included, payload last) and when it left, in Unix nanoseconds
+    static size_t read_transmit_timestamps(int socket_fd, uint8_t* buffer, size_t size,
+                                           const std::function<void(const uint8_t*, size_t, int64_t)>& callback);
 
     // Time utilities
     static uint32_t get_system_time();
@@ -52,6 +90,7 @@ public:
 
     // Process utilities
     static int get_process_id();
+    static bool set_thread_affinity(int cpu);
     static std::string get_process_name();
     static bool daemonize();
 
@@ -60,7 +99,7 @@ public:
     static void set_last_error(const std::string& error);
 
 private:
-    static std::string last_error_;
+    static thread_local std::string last_error_;
 };
 
 } // namespace simple_utcd
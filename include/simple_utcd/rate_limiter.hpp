@@ -0,0 +1,97 @@
+/*
+ * includes/simple_utcd/rate_limiter.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct sockaddr_storage;
+
+namespace simple_utcd {
+
+/**
+ * @brief Per-source-address token buckets
+ *
+ * Buckets live in fixed-size open-addressing tables, one per shard, so the
+ * limiter never allocates after construction. A source address hashes to
+ * a shard and a home slot; probing is bounded, and when every slot in the
+ * probe window is taken by another address the least recently seen one is
+ * evicted. Buckets refill lazily on lookup from the elapsed time.
+ */
+class RateLimiter {
+public:
+    /**
+     * @param table_size total number of tracked addresses across all shards
+     * @param shards number of independently locked tables (rounded up to a power of two)
+     */
+    RateLimiter(size_t table_size, size_t shards, int requests_per_minute, int burst_size);
+
+    RateLimiter(const RateLimiter&) = delete;
+    RateLimiter& operator=(const RateLimiter&) = delete;
+
+    /**
+     * @brief Take one token for @p address
+     * @param now_ns steady clock reading, so a batch can share one clock read
+     * @return false if the address is over its rate and the request should be dropped
+     */
+    bool allow(const struct sockaddr_storage& address, uint64_t now_ns);
+    bool allow(const struct sockaddr_storage& address);
+
+    static uint64_t now_ns();
+
+    size_t shard_count() const { return shard_count_; }
+    std::vector<uint64_t> get_shard_drop_counts() const;
+    uint64_t get_dropped() const;
+    uint64_t get_evictions() const;
+
+private:
+    // Probe window per lookup; also the eviction candidate set
+    static constexpr size_t MAX_PROBE = 8;
+
+    struct Slot {
+        uint64_t key[2] = {0, 0};     // address as 16 bytes, IPv4 in mapped form
+        uint64_t last_ns = 0;         // last refill; 0 marks an empty slot
+        double tokens = 0.0;
+    };
+
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::unique_ptr<Slot[]> slots;
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<uint64_t> evictions{0};
+    };
+
+    size_t shard_count_;
+    size_t shard_mask_;
+    size_t slots_per_shard_;
+    size_t slot_mask_;
+    double tokens_per_ns_;
+    double burst_;
+    std::unique_ptr<Shard[]> shards_;
+
+    static bool make_key(const struct sockaddr_storage& address, uint64_t key[2]);
+    static uint64_t hash(const uint64_t key[2]);
+    static size_t round_up(size_t value);
+};
+
+} // namespace simple_utcd
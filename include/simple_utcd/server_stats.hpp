@@ -0,0 +1,93 @@
+/*
+ * includes/simple_utcd/server_stats.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace simple_utcd {
+
+enum class Counter : size_t {
+    CONNECTIONS_ACCEPTED = 0,
+    CONNECTIONS_CLOSED,
+    CONNECTIONS_DENIED,      // refused by the access control list (TCP and UDP)
+    CONNECTIONS_REJECTED,    // TCP connections closed unserved by the rate limiter or a capacity limit
+    CONNECTIONS_TIMED_OUT,
+    PACKETS_SENT,
+    PACKETS_RECEIVED,
+    ACCEPT_FAILED,           // accept() errors other than an empty backlog, e.g. descriptor exhaustion
+    COUNT
+};
+
+/**
+ * @brief Point-in-time totals summed across all counter slots
+ *
+ * Slots are read one after another without stopping writers, so the
+ * totals are each exact but not taken at a single instant.
+ */
+struct StatsSnapshot {
+    uint64_t total_connections = 0;
+    uint64_t active_connections = 0;
+    uint64_t connections_denied = 0;
+    uint64_t connections_rejected = 0;
+    uint64_t connections_timed_out = 0;
+    uint64_t packets_sent = 0;
+    uint64_t packets_received = 0;
+    uint64_t accept_failures = 0;
+};
+
+/**
+ * @brief Monotonic 64-bit counters striped per thread
+ *
+ * Each thread that records a value is given its own slot, one cache line
+ * wide, on first use; slots are only shared when there are more threads
+ * than slots. Gauges such as active connections are derived from two
+ * counters at snapshot time rather than being decremented in place.
+ */
+class ServerStats {
+public:
+    explicit ServerStats(size_t slots);
+
+    ServerStats(const ServerStats&) = delete;
+    ServerStats& operator=(const ServerStats&) = delete;
+
+    void add(Counter counter, uint64_t value = 1) {
+        slot().values[static_cast<size_t>(counter)].fetch_add(value, std::memory_order_relaxed);
+    }
+
+    uint64_t get(Counter counter) const;
+    StatsSnapshot snapshot() const;
+
+private:
+    static constexpr size_t COUNTERS = static_cast<size_t>(Counter::COUNT);
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> values[COUNTERS];
+    };
+
+    size_t slot_count_;
+    std::unique_ptr<Slot[]> slots_;
+
+    Slot& slot() { return slots_[thread_index() % slot_count_]; }
+    static size_t thread_index();
+};
+
+} // namespace simple_utcd
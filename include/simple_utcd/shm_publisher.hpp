@@ -0,0 +1,78 @@
+/*
+ * includes/simple_utcd/shm_publisher.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "shm_time.hpp"
+
+namespace simple_utcd {
+
+class Logger;
+class TimeSynchronizer;
+
+/**
+ * @brief Writes the served time into a POSIX shared-memory segment
+ *
+ * Local clients map the segment with ShmTimeReader (shm_time.hpp) and
+ * read the time without a syscall instead of connecting over loopback.
+ * A thread refreshes the segment every UPDATE_INTERVAL_MS; readers derive
+ * the current time from their own clock plus the published offset, so
+ * the interval only bounds how late an offset change or a stall shows up.
+ * On stop the segment is marked stopped but left in place, so readers
+ * keep their mapping across daemon restarts.
+ */
+class ShmPublisher {
+public:
+    /**
+     * @param synchronizer upstream state; null when serving the local clock
+     */
+    ShmPublisher(const std::string& name, const TimeSynchronizer* synchronizer, Logger* logger);
+    ~ShmPublisher();
+
+    ShmPublisher(const ShmPublisher&) = delete;
+    ShmPublisher& operator=(const ShmPublisher&) = delete;
+
+    bool start();
+    void stop();
+
+    /**
+     * @brief Write the current state once; called by the publisher thread
+     */
+    void publish();
+
+    static constexpr uint32_t UPDATE_INTERVAL_MS = 100;
+
+private:
+    std::string name_;
+    const TimeSynchronizer* synchronizer_;
+    Logger* logger_;
+    ShmTimeSegment* segment_;
+
+    bool running_;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+
+    void thread_main();
+};
+
+} // namespace simple_utcd
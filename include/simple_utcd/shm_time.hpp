@@ -0,0 +1,227 @@
+/*
+ * includes/simple_utcd/shm_time.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+// Header-only: local clients include this and nothing else from the daemon
+
+#include <atomic>
+#include <cstdint>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace simple_utcd {
+
+constexpr const char* SHM_TIME_DEFAULT_NAME = "/simple-utcd-time";
+constexpr uint32_t SHM_TIME_MAGIC = 0x55544344;  // "UTCD"
+constexpr uint32_t SHM_TIME_VERSION = 1;
+
+/**
+ * @brief What the served clock is disciplined by
+ */
+enum class ShmTimeState : uint32_t {
+    LOCAL = 0,           // no upstreams configured; the system clock is served as is
+    UNSYNCHRONIZED = 1,  // upstreams configured but none has answered yet
+    SYNCHRONIZED = 2,    // offset_ns tracks the upstreams
+    STOPPED = 3          // the daemon shut down; nothing is updating the segment
+};
+
+/**
+ * @brief Layout of the shared segment
+ *
+ * The daemon is the only writer. sequence is odd while an update is in
+ * progress and advances by two per update; readers retry until they see
+ * the same even value before and after copying the fields. Every field is
+ * a lock-free atomic so the copy is race-free across processes.
+ */
+struct ShmTimeSegment {
+    std::atomic<uint32_t> magic;       // SHM_TIME_MAGIC once the segment is initialized
+    uint32_t version;                  // SHM_TIME_VERSION
+    uint32_t update_interval_ms;       // how often the daemon refreshes the segment
+    std::atomic<uint32_t> sequence;
+
+    std::atomic<int64_t> seconds;      // served time at the last update, Unix seconds
+    std::atomic<uint32_t> nanoseconds; // and its fraction
+    std::atomic<uint32_t> leap;        // NTP leap indicator: 0 none, 3 clock not synchronized
+    std::atomic<int64_t> offset_ns;    // served time minus CLOCK_REALTIME
+    std::atomic<int64_t> max_error_ns; // upstream round trip / 2 plus dispersion
+    std::atomic<uint32_t> state;       // ShmTimeState
+    uint32_t reserved;
+
+    static_assert(std::atomic<int64_t>::is_always_lock_free, "shared atomics must be lock-free");
+    static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared atomics must be lock-free");
+};
+
+/**
+ * @brief One consistent copy of the segment
+ */
+struct ShmTime {
+    int64_t seconds = 0;
+    uint32_t nanoseconds = 0;
+    uint32_t leap = 0;
+    int64_t offset_ns = 0;
+    int64_t max_error_ns = 0;
+    ShmTimeState state = ShmTimeState::STOPPED;
+    uint32_t update_interval_ms = 0;
+};
+
+/**
+ * @brief Seqlock update, used by the daemon
+ */
+inline void shm_time_write(ShmTimeSegment& segment, const ShmTime& time) {
+    uint32_t sequence = segment.sequence.load(std::memory_order_relaxed);
+    segment.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    segment.seconds.store(time.seconds, std::memory_order_relaxed);
+    segment.nanoseconds.store(time.nanoseconds, std::memory_order_relaxed);
+    segment.leap.store(time.leap, std::memory_order_relaxed);
+    segment.offset_ns.store(time.offset_ns, std::memory_order_relaxed);
+    segment.max_error_ns.store(time.max_error_ns, std::memory_order_relaxed);
+    segment.state.store(static_cast<uint32_t>(time.state), std::memory_order_relaxed);
+
+    segment.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+// An update is a few stores, so a sequence that stays odd this long belongs to a writer that died
+constexpr int SHM_TIME_READ_ATTEMPTS = 10000;
+
+/**
+ * @brief Seqlock read; retries only while an update is in flight
+ * @return false if the segment was never initialized, or no consistent copy
+ *         could be taken because the daemon died in the middle of an update
+ */
+inline bool shm_time_read(const ShmTimeSegment& segment, ShmTime& time) {
+    if (segment.magic.load(std::memory_order_acquire) != SHM_TIME_MAGIC ||
+        segment.version != SHM_TIME_VERSION) {
+        return false;
+    }
+
+    uint32_t before;
+    uint32_t after;
+    int attempts = 0;
+    do {
+        if (attempts++ == SHM_TIME_READ_ATTEMPTS) {
+            return false;
+        }
+        before = segment.sequence.load(std::memory_order_acquire);
+        time.seconds = segment.seconds.load(std::memory_order_relaxed);
+        time.nanoseconds = segment.nanoseconds.load(std::memory_order_relaxed);
+        time.leap = segment.leap.load(std::memory_order_relaxed);
+        time.offset_ns = segment.offset_ns.load(std::memory_order_relaxed);
+        time.max_error_ns = segment.max_error_ns.load(std::memory_order_relaxed);
+        time.state = static_cast<ShmTimeState>(segment.state.load(std::memory_order_relaxed));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = segment.sequence.load(std::memory_order_relaxed);
+    } while ((before & 1) != 0 || before != after);
+
+    time.update_interval_ms = segment.update_interval_ms;
+    return true;
+}
+
+#ifndef _WIN32
+
+/**
+ * @brief Read-only view of the daemon's time segment for local clients
+ *
+ * Opening maps the segment once; after that read() is a handful of loads
+ * and now() adds a CLOCK_REALTIME read, which is served from the vDSO on
+ * Linux, so neither enters the kernel. The daemon keeps the segment
+ * across restarts, so a reader opened once keeps working; construct a new
+ * reader if is_open() was false because the daemon had not started yet.
+ *
+ * @code
+ * simple_utcd::ShmTimeReader reader;
+ * int64_t utc_ns;
+ * if (reader.now(utc_ns)) { ... }
+ * @endcode
+ */
+class ShmTimeReader {
+public:
+    explicit ShmTimeReader(const char* name = SHM_TIME_DEFAULT_NAME) : segment_(nullptr) {
+        int fd = shm_open(name, O_RDONLY, 0);
+        if (fd < 0) {
+            return;
+        }
+        void* mapping = mmap(nullptr, sizeof(ShmTimeSegment), PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapping != MAP_FAILED) {
+            segment_ = static_cast<const ShmTimeSegment*>(mapping);
+        }
+    }
+
+    ~ShmTimeReader() {
+        if (segment_) {
+            munmap(const_cast<ShmTimeSegment*>(segment_), sizeof(ShmTimeSegment));
+        }
+    }
+
+    ShmTimeReader(const ShmTimeReader&) = delete;
+    ShmTimeReader& operator=(const ShmTimeReader&) = delete;
+
+    bool is_open() const { return segment_ != nullptr; }
+
+    /**
+     * @brief Copy of the last update
+     */
+    bool read(ShmTime& time) const {
+        return segment_ && shm_time_read(*segment_, time);
+    }
+
+    /**
+     * @brief Current served time, Unix nanoseconds
+     * @return false if the segment is missing, the daemon stopped or its clock is not synchronized
+     */
+    bool now(int64_t& unix_ns) const {
+        ShmTime time;
+        if (!read(time) || time.state == ShmTimeState::STOPPED || time.state == ShmTimeState::UNSYNCHRONIZED) {
+            return false;
+        }
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        unix_ns = static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec + time.offset_ns;
+        return true;
+    }
+
+    /**
+     * @brief True if the daemon missed several updates in a row (hung or killed)
+     */
+    bool is_stale() const {
+        ShmTime time;
+        if (!read(time) || time.state == ShmTimeState::STOPPED) {
+            return true;
+        }
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        int64_t now_ns = static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec + time.offset_ns;
+        int64_t updated_ns = time.seconds * 1000000000 + time.nanoseconds;
+        return now_ns - updated_ns > static_cast<int64_t>(time.update_interval_ms) * 1000000 * 4;
+    }
+
+private:
+    const ShmTimeSegment* segment_;
+};
+
+#endif
+
+} // namespace simple_utcd
@@ -0,0 +1,153 @@
+/*
+ * includes/simple_utcd/snapshot.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace simple_utcd {
+
+/**
+ * @brief Immutable value that is replaced wholesale, with epoch-based reclamation
+ *
+ * Every reader thread owns one slot. pin() announces the current epoch in
+ * that slot and loads the snapshot, so a read costs two stores and a load
+ * and never takes a lock or touches a shared reference count. publish()
+ * swaps in the new snapshot, advances the epoch and retires the old one
+ * under the epoch it was current in; it is freed once every slot is idle
+ * or announces a later epoch. Pins must be short and must not nest, since
+ * a pinned slot holds back every snapshot retired after it.
+ *
+ * The writer side (publish, reclaim, current) is not synchronized with
+ * itself; callers serialize it.
+ */
+template<typename T>
+class SnapshotCell {
+public:
+    class Guard {
+    public:
+        ~Guard() { epoch_.store(IDLE, std::memory_order_release); }
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+        const T& operator*() const { return *value_; }
+        const T* operator->() const { return value_; }
+
+    private:
+        friend class SnapshotCell;
+
+        Guard(std::atomic<uint64_t>& epoch, const T* value) : epoch_(epoch), value_(value) {}
+
+        std::atomic<uint64_t>& epoch_;
+        const T* value_;
+    };
+
+    SnapshotCell(std::unique_ptr<const T> initial, size_t readers)
+        : current_(initial.release())
+        , epoch_(1)
+        , slots_(new Slot[std::max<size_t>(1, readers)])
+        , slot_count_(std::max<size_t>(1, readers))
+    {
+    }
+
+    ~SnapshotCell() {
+        delete current_.load(std::memory_order_relaxed);
+        for (const auto& retired : retired_) {
+            delete retired.value;
+        }
+    }
+
+    SnapshotCell(const SnapshotCell&) = delete;
+    SnapshotCell& operator=(const SnapshotCell&) = delete;
+
+    /**
+     * @brief Pin the current snapshot for @p reader until the guard goes out of scope
+     */
+    Guard pin(size_t reader) const {
+        // Announce before loading: a writer that misses the announcement has already swapped
+        std::atomic<uint64_t>& epoch = slots_[reader].epoch;
+        epoch.store(epoch_.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+        return Guard(epoch, current_.load(std::memory_order_seq_cst));
+    }
+
+    /**
+     * @brief The published snapshot, for the writer side only
+     */
+    const T* current() const { return current_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Make @p next current and retire the previous snapshot
+     */
+    void publish(std::unique_ptr<const T> next) {
+        const T* previous = current_.exchange(next.release(), std::memory_order_seq_cst);
+        uint64_t retired_in = epoch_.fetch_add(1, std::memory_order_seq_cst);
+        retired_.push_back({previous, retired_in});
+        reclaim();
+    }
+
+    /**
+     * @brief Free retired snapshots no reader can still hold
+     * @return Number still waiting for a reader to move on
+     */
+    size_t reclaim() {
+        uint64_t oldest = std::numeric_limits<uint64_t>::max();
+        for (size_t i = 0; i < slot_count_; ++i) {
+            uint64_t epoch = slots_[i].epoch.load(std::memory_order_seq_cst);
+            if (epoch != IDLE) {
+                oldest = std::min(oldest, epoch);
+            }
+        }
+
+        auto freed = std::remove_if(retired_.begin(), retired_.end(), [oldest](const Retired& retired) {
+            if (retired.epoch < oldest) {
+                delete retired.value;
+                return true;
+            }
+            return false;
+        });
+        retired_.erase(freed, retired_.end());
+        return retired_.size();
+    }
+
+private:
+    static constexpr uint64_t IDLE = 0;
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch{IDLE};
+    };
+
+    struct Retired {
+        const T* value;
+        uint64_t epoch;  // last epoch in which it was current
+    };
+
+    std::atomic<const T*> current_;
+    std::atomic<uint64_t> epoch_;
+    std::unique_ptr<Slot[]> slots_;
+    size_t slot_count_;
+    std::vector<Retired> retired_;
+};
+
+} // namespace simple_utcd
@@ -0,0 +1,100 @@
+/*
+ * includes/simple_utcd/time_source.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace simple_utcd {
+
+/**
+ * @brief Process-wide "current second" cell refreshed by a ticker thread
+ *
+ * RFC 868 replies only carry whole seconds, so the ticker publishes the
+ * seconds value once per second, aligned to the second boundary, together
+ * with the deadline it stays good until: the next boundary plus
+ * LAG_TOLERANCE_MS on a coarse monotonic clock. Readers do a single
+ * relaxed load and a cheap clock check. While the ticker is stopped, waking
+ * up late or stalled past the deadline, readers fall back to reading the
+ * clock directly.
+ *
+ * The served time is the system clock plus an offset published by the
+ * upstream synchronizer; with no synchronizer the offset stays zero.
+ */
+class TimeSource {
+public:
+    static TimeSource& instance();
+
+    void start();
+    void stop();
+    bool is_running() const { return running_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief True while the cell is being refreshed on schedule and has not expired
+     */
+    bool is_ticker_healthy() const;
+
+    uint32_t now_seconds() const;
+    std::array<uint8_t, 4> current_reply() const;
+
+    /**
+     * @brief Read the corrected clock, bypassing the cache
+     */
+    uint32_t read_clock() const;
+
+    /**
+     * @brief Correction added to the system clock, in nanoseconds
+     */
+    int64_t offset_ns() const { return offset_ns_.load(std::memory_order_relaxed); }
+    void set_offset_ns(int64_t offset);
+
+    // A tick this late (in milliseconds) sends readers to the clock until it recovers
+    static constexpr int LAG_TOLERANCE_MS = 50;
+
+private:
+    TimeSource();
+    ~TimeSource();
+
+    TimeSource(const TimeSource&) = delete;
+    TimeSource& operator=(const TimeSource&) = delete;
+
+    // Seconds in the high half, the deadline in coarse monotonic milliseconds (mod 2^32) in the low half
+    struct alignas(64) Cell {
+        std::atomic<uint64_t> packed{0};
+    };
+
+    Cell cell_;
+    std::atomic<int64_t> offset_ns_;
+    std::atomic<bool> running_;
+    std::thread ticker_;
+    std::mutex ticker_mutex_;
+    std::condition_variable ticker_cv_;
+
+    void ticker_main();
+    void publish();
+
+    // The cached seconds, or 0 when the cell is cleared or past its deadline
+    uint32_t cached_seconds() const;
+};
+
+} // namespace simple_utcd
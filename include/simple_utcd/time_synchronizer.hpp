@@ -0,0 +1,171 @@
+/*
+ * includes/simple_utcd/time_synchronizer.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <sys/socket.h>
+#endif
+
+namespace simple_utcd {
+
+class UTCConfig;
+class Logger;
+
+/**
+ * @brief One upstream_servers entry
+ *
+ * Written as [scheme://]host[:port]. "ntp" (the default) speaks SNTP on
+ * UDP 123, "time" is RFC 868 over TCP 37 and "time-udp" RFC 868 over
+ * UDP 37. IPv6 literals go in brackets.
+ */
+struct Upstream {
+    enum class Protocol { SNTP, TIME_TCP, TIME_UDP };
+
+    std::string spec;
+    Protocol protocol = Protocol::SNTP;
+    std::string host;
+    int port = 123;
+
+    static bool parse(const std::string& spec, Upstream& upstream);
+};
+
+/**
+ * @brief One request/response exchange, relative to the system clock
+ */
+struct TimeSample {
+    int64_t offset_ns = 0;  // upstream minus local
+    int64_t delay_ns = 0;   // round trip spent on the network
+    int64_t error_ns = 0;   // upstream's own uncertainty (resolution, root distance)
+
+    // Worst-case error of offset_ns
+    int64_t distance_ns() const { return delay_ns / 2 + error_ns; }
+};
+
+/**
+ * @brief Keeps the served time in step with upstream servers
+ *
+ * Every sync_interval seconds all upstreams are queried at once over
+ * non-blocking sockets, bounded by the timeout setting. Host names are
+ * looked up by the sync thread between rounds and cached for an hour. Each upstream
+ * keeps its last few samples and contributes the one with the lowest
+ * delay; the estimate is the median of the contributions close to the
+ * best one, stepped to when far off and slewed towards otherwise. A step
+ * larger than max_step is refused, so one misconfigured upstream cannot
+ * throw the served time years off. The result is published as the TimeSource offset, so serving threads never
+ * wait on the network.
+ */
+class TimeSynchronizer {
+public:
+    TimeSynchronizer(const UTCConfig* config, Logger* logger);
+    ~TimeSynchronizer();
+
+    TimeSynchronizer(const TimeSynchronizer&) = delete;
+    TimeSynchronizer& operator=(const TimeSynchronizer&) = delete;
+
+    bool start();
+    void stop();
+
+    /**
+     * @brief Wake the sync thread for an immediate round
+     */
+    void request_poll();
+
+    /**
+     * @brief Query every upstream once and fold the answers into the estimate
+     *
+     * Runs on the sync thread; callable directly when the thread is not started.
+     * @return number of upstreams that answered
+     */
+    size_t poll_once();
+
+    bool is_synchronized() const { return synchronized_.load(std::memory_order_relaxed); }
+    int64_t get_offset_ns() const { return offset_ns_.load(std::memory_order_relaxed); }
+    size_t get_reachable() const { return reachable_.load(std::memory_order_relaxed); }
+    size_t get_upstream_count() const { return upstreams_.size(); }
+
+    // Path to the upstreams as NTP reports it: round trip and error of the best vote
+    int64_t get_root_delay_ns() const { return root_delay_ns_.load(std::memory_order_relaxed); }
+    int64_t get_root_dispersion_ns() const { return root_dispersion_ns_.load(std::memory_order_relaxed); }
+
+    // Served (corrected) time of the last estimate update, Unix nanoseconds
+    int64_t get_reference_time_ns() const { return reference_time_ns_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Pure sample arithmetic, exposed for the poll code and for tests
+     * @param t1_ns local send time, @p t4_ns local receive time (Unix ns)
+     */
+    static bool sntp_sample(const uint8_t* packet, size_t size, uint64_t expected_origin,
+                            int64_t t1_ns, int64_t t4_ns, TimeSample& sample);
+    static bool rfc868_sample(const uint8_t* packet, size_t size,
+                              int64_t t1_ns, int64_t t4_ns, TimeSample& sample);
+
+    // Samples kept per upstream, and polls an upstream may miss before they are dropped
+    static constexpr size_t FILTER_SIZE = 8;
+
+    // Further than this from the estimate is stepped to rather than slewed
+    static constexpr int64_t STEP_THRESHOLD_NS = 128000000;
+
+private:
+    struct Source {
+        Upstream upstream;
+        std::deque<TimeSample> samples;
+        uint8_t reach = 0;  // one bit per poll, set when it answered
+
+        // Cached lookup, so a poll never waits on DNS
+        struct sockaddr_storage address;
+        socklen_t address_length = 0;
+        int64_t resolved_ms = 0;
+        bool literal = false;  // an address literal never needs another lookup
+    };
+
+    const UTCConfig* config_;
+    Logger* logger_;
+    std::vector<Source> upstreams_;
+    int64_t max_step_ns_;  // 0 when steps are unbounded
+
+    std::atomic<int64_t> offset_ns_;
+    std::atomic<bool> synchronized_;
+    std::atomic<size_t> reachable_;
+    std::atomic<int64_t> root_delay_ns_;
+    std::atomic<int64_t> root_dispersion_ns_;
+    std::atomic<int64_t> reference_time_ns_;
+
+    bool running_;
+    bool poll_requested_;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+
+    void thread_main();
+    void resolve_upstreams(bool numeric_only);
+    void update_estimate();
+};
+
+} // namespace simple_utcd
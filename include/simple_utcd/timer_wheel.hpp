@@ -0,0 +1,106 @@
+/*
+ * includes/simple_utcd/timer_wheel.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace simple_utcd {
+
+/**
+ * @brief Hashed timer wheel for one worker thread
+ *
+ * Timers are intrusive list nodes embedded in their owner, so arming and
+ * cancelling are O(1) and never allocate. A timer hashes into the slot of
+ * its expiry tick; deadlines further out than one revolution stay in their
+ * slot and are skipped until their lap comes round. Not thread-safe: each
+ * event loop worker owns its own wheel.
+ */
+class TimerWheel {
+public:
+    struct Timer {
+        Timer* prev = nullptr;
+        Timer* next = nullptr;
+        uint64_t expires = 0;   // absolute tick
+        void* data = nullptr;
+
+        bool is_armed() const { return prev != nullptr; }
+    };
+
+    /**
+     * @param slots wheel size, rounded up to a power of two
+     * @param tick_ms resolution; deadlines are rounded up to whole ticks
+     */
+    TimerWheel(size_t slots, uint32_t tick_ms);
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    /**
+     * @brief Arm (or re-arm) @p timer to fire @p delay_ms from @p now_ms
+     */
+    void schedule(Timer& timer, uint32_t delay_ms, uint64_t now_ms);
+    void cancel(Timer& timer);
+
+    /**
+     * @brief Run every timer whose tick has passed
+     *
+     * Expired timers are unlinked before @p on_expire sees them, so the
+     * callback may destroy the timer's owner or re-arm it.
+     * @return Number of timers fired
+     */
+    template<typename Callback>
+    size_t advance(uint64_t now_ms, Callback&& on_expire) {
+        Timer* expired = collect(now_ms);
+        size_t fired = 0;
+        while (expired) {
+            Timer* timer = expired;
+            expired = timer->next;
+            timer->next = nullptr;
+            on_expire(*timer);
+            fired++;
+        }
+        return fired;
+    }
+
+    /**
+     * @brief Milliseconds until the next tick, or -1 if nothing is armed
+     *
+     * Meant as the event loop's wait timeout.
+     */
+    int next_timeout_ms(uint64_t now_ms) const;
+
+    size_t size() const { return armed_; }
+    uint32_t tick_ms() const { return tick_ms_; }
+
+    static uint64_t now_ms();
+
+private:
+    std::vector<Timer> slots_;  // list heads; each slot is a circular list through its head
+    size_t mask_;
+    uint32_t tick_ms_;
+    uint64_t current_tick_;
+    size_t armed_;
+
+    Timer* collect(uint64_t now_ms);
+    static void unlink(Timer& timer);
+};
+
+} // namespace simple_utcd
@@ -0,0 +1,96 @@
+/*
+ * includes/simple_utcd/udp_batch.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+struct sockaddr_storage;
+
+namespace simple_utcd {
+
+/**
+ * @brief Batched datagram receive/reply buffers
+ *
+ * Uses recvmmsg/sendmmsg on Linux so a whole batch of requests costs one
+ * syscall in each direction; other platforms fall back to a
+ * recvfrom/sendto loop over the same slots.
+ *
+ * With receive timestamps on, each message also carries a control buffer
+ * so the kernel's receive stamp can be read back per datagram (see
+ * Platform::enable_timestamping).
+ */
+class UDPBatch {
+public:
+    UDPBatch(size_t capacity, size_t buffer_size, bool receive_timestamps = false);
+    ~UDPBatch();
+
+    UDPBatch(const UDPBatch&) = delete;
+    UDPBatch& operator=(const UDPBatch&) = delete;
+
+    size_t capacity() const { return capacity_; }
+
+    /**
+     * @brief Read up to capacity() datagrams from a non-blocking socket
+     * @return Number of datagrams received, 0 if none are pending, -1 on error
+     */
+    int receive(int socket_fd);
+
+    const uint8_t* data(int index) const;
+    uint8_t* mutable_data(int index);  // for replies built in place over the request
+    size_t size(int index) const;
+    const struct sockaddr_storage& peer(int index) const;
+
+    /**
+     * @brief Kernel receive time of datagram @p index (Unix nanoseconds)
+     * @return 0 when timestamps are off or the kernel attached none
+     */
+    int64_t receive_time_ns(int index) const;
+
+    /**
+     * @brief Queue a reply to the sender of datagram @p index
+     *
+     * The reply buffer is referenced, not copied, and must stay valid
+     * until send_replies() returns.
+     */
+    void add_reply(int index, const void* data, size_t size);
+
+    // Queued replies, still writable until send_replies()
+    size_t reply_count() const { return pending_; }
+    uint8_t* reply_data(size_t reply);
+
+    /**
+     * @brief Send every queued reply and clear the queue
+     * @return Number of replies the kernel accepted
+     */
+    int send_replies(int socket_fd);
+
+private:
+    struct Buffers;
+
+    size_t capacity_;
+    size_t buffer_size_;
+    bool receive_timestamps_;
+    std::unique_ptr<Buffers> buffers_;
+    size_t received_;
+    size_t pending_;
+};
+
+} // namespace simple_utcd
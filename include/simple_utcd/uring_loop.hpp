@@ -0,0 +1,92 @@
+/*
+ * includes/simple_utcd/uring_loop.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace simple_utcd {
+
+/**
+ * @brief io_uring completion loop owned by a single worker thread
+ *
+ * Covers exactly what the RFC 868 TCP path needs: a multishot accept on
+ * the listener, and a write from a registered buffer hard-linked to the
+ * close of the same socket, so a connection costs no syscalls of its own.
+ * Built only when liburing is found at configure time; otherwise, or when
+ * the kernel lacks multishot accept (5.19), is_supported() returns false
+ * and the server falls back to the epoll loop.
+ */
+class UringLoop {
+public:
+    struct Completion {
+        uint64_t user_data;
+        int32_t result;
+        uint32_t flags;
+    };
+
+    explicit UringLoop(unsigned entries);
+    ~UringLoop();
+
+    UringLoop(const UringLoop&) = delete;
+    UringLoop& operator=(const UringLoop&) = delete;
+
+    static bool is_supported();
+    bool is_valid() const;
+
+    /**
+     * @brief Pin @p size bytes at @p data as fixed buffer 0
+     */
+    bool register_buffer(void* data, size_t size);
+
+    /**
+     * @brief Queue an accept that keeps posting one completion per connection
+     */
+    bool accept_multishot(int listen_fd, uint64_t user_data);
+
+    /**
+     * @brief Queue a write of @p size bytes at @p data, inside fixed buffer 0, then close @p fd
+     *
+     * The close runs whether or not the write succeeds and posts no
+     * completion unless it fails; it carries @p close_data.
+     */
+    bool write_fixed_and_close(int fd, const uint8_t* data, size_t size,
+                               uint64_t user_data, uint64_t close_data);
+
+    /**
+     * @brief Submit queued requests and wait for completions
+     * @return Number of completions, 0 on timeout, -1 on error
+     */
+    int wait(int timeout_ms);
+    const Completion& completion(int index) const { return completions_[static_cast<size_t>(index)]; }
+
+    /**
+     * @brief False once a multishot request has posted its last completion
+     */
+    static bool has_more(uint32_t flags);
+
+private:
+    struct Ring;
+    std::unique_ptr<Ring> ring_;
+    std::vector<Completion> completions_;
+};
+
+} // namespace simple_utcd
@@ -24,6 +24,17 @@
 
 namespace simple_utcd {
 
+class AccessControl;
+
+/**
+ * @brief How a TCP connection is closed after its reply (close_strategy)
+ */
+enum class CloseStrategy {
+    NORMAL,    // close() right away; the server is the active closer and keeps TIME_WAIT
+    GRACEFUL,  // wait (bounded) for the client to close first, so TIME_WAIT lands on the client
+    ABORTIVE   // SO_LINGER {1, 0}: reset instead of FIN, no TIME_WAIT on either side
+};
+
 class UTCConfig {
 public:
     UTCConfig();
@@ -37,11 +48,28 @@ public:
     int get_listen_port() const { return listen_port_; }
     bool is_ipv6_enabled() const { return enable_ipv6_; }
     int get_max_connections() const { return max_connections_; }
+    int get_connection_timeout() const { return connection_timeout_; }
+    CloseStrategy get_close_strategy() const { return close_strategy_; }
+    int get_close_wait_timeout() const { return close_wait_timeout_; }
+    int get_listen_backlog() const { return listen_backlog_; }
+    int get_socket_buffer_size() const { return socket_buffer_size_; }
+    bool is_tcp_fastopen_enabled() const { return enable_tcp_fastopen_; }
+    int get_tcp_fastopen_queue_size() const { return tcp_fastopen_queue_size_; }
 
     void set_listen_address(const std::string& address) { listen_address_ = address; }
     void set_listen_port(int port) { listen_port_ = port; }
     void set_ipv6_enabled(bool enabled) { enable_ipv6_ = enabled; }
     void set_max_connections(int max) { max_connections_ = max; }
+    void set_connection_timeout(int timeout) { connection_timeout_ = timeout; }
+    void set_close_strategy(CloseStrategy strategy) { close_strategy_ = strategy; }
+    void set_close_wait_timeout(int timeout) { close_wait_timeout_ = timeout; }
+    void set_listen_backlog(int backlog) { listen_backlog_ = backlog; }
+    void set_socket_buffer_size(int size) { socket_buffer_size_ = size; }
+    void set_tcp_fastopen_enabled(bool enabled) { enable_tcp_fastopen_ = enabled; }
+    void set_tcp_fastopen_queue_size(int size) { tcp_fastopen_queue_size_ = size; }
+
+    static const char* close_strategy_name(CloseStrategy strategy);
+    static bool parse_close_strategy(const std::string& name, CloseStrategy& strategy);
 
     // UTC Server Configuration
     int get_stratum() const { return stratum_; }
@@ -50,6 +78,10 @@ public:
     const std::vector<std::string>& get_upstream_servers() const { return upstream_servers_; }
     int get_sync_interval() const { return sync_interval_; }
     int get_timeout() const { return timeout_; }
+    int get_max_step() const { return max_step_; }
+    bool is_upstream_sync_enabled() const { return enable_upstream_sync_; }
+    bool is_shm_time_enabled() const { return enable_shm_time_; }
+    const std::string& get_shm_time_name() const { return shm_time_name_; }
 
     void set_stratum(int stratum) { stratum_ = stratum; }
     void set_reference_id(const std::string& id) { reference_id_ = id; }
@@ -57,17 +89,31 @@ public:
     void set_upstream_servers(const std::vector<std::string>& servers) { upstream_servers_ = servers; }
     void set_sync_interval(int interval) { sync_interval_ = interval; }
     void set_timeout(int timeout) { timeout_ = timeout; }
+    void set_max_step(int seconds) { max_step_ = seconds; }
+    void set_upstream_sync_enabled(bool enabled) { enable_upstream_sync_ = enabled; }
+    void set_shm_time_enabled(bool enabled) { enable_shm_time_ = enabled; }
+    void set_shm_time_name(const std::string& name) { shm_time_name_ = name; }
 
     // Logging Configuration
     const std::string& get_log_file() const { return log_file_; }
     const std::string& get_log_level() const { return log_level_; }
     bool is_console_logging_enabled() const { return enable_console_logging_; }
     bool is_syslog_enabled() const { return enable_syslog_; }
+    bool is_async_logging_enabled() const { return log_async_; }
+    int get_log_queue_size() const { return log_queue_size_; }
+    int get_log_flush_interval() const { return log_flush_interval_; }
+    int get_log_flush_size() const { return log_flush_size_; }
+    const std::string& get_log_overflow_policy() const { return log_overflow_policy_; }
 
     void set_log_file(const std::string& file) { log_file_ = file; }
     void set_log_level(const std::string& level) { log_level_ = level; }
     void set_console_logging_enabled(bool enabled) { enable_console_logging_ = enabled; }
     void set_syslog_enabled(bool enabled) { enable_syslog_ = enabled; }
+    void set_async_logging_enabled(bool enabled) { log_async_ = enabled; }
+    void set_log_queue_size(int size) { log_queue_size_ = size; }
+    void set_log_flush_interval(int interval) { log_flush_interval_ = interval; }
+    void set_log_flush_size(int size) { log_flush_size_ = size; }
+    void set_log_overflow_policy(const std::string& policy) { log_overflow_policy_ = policy; }
 
     // Security Configuration
     bool is_authentication_enabled() const { return enable_authentication_; }
@@ -75,23 +121,64 @@ public:
     bool is_query_restriction_enabled() const { return restrict_queries_; }
     const std::vector<std::string>& get_allowed_clients() const { return allowed_clients_; }
     const std::vector<std::string>& get_denied_clients() const { return denied_clients_; }
+    std::shared_ptr<const AccessControl> get_access_control() const { return access_control_; }
+    bool is_rate_limiting_enabled() const { return enable_rate_limiting_; }
+    int get_rate_limit_requests_per_minute() const { return rate_limit_requests_per_minute_; }
+    int get_rate_limit_burst_size() const { return rate_limit_burst_size_; }
+    int get_rate_limit_table_size() const { return rate_limit_table_size_; }
 
     void set_authentication_enabled(bool enabled) { enable_authentication_ = enabled; }
     void set_authentication_key(const std::string& key) { authentication_key_ = key; }
-    void set_query_restriction_enabled(bool enabled) { restrict_queries_ = enabled; }
-    void set_allowed_clients(const std::vector<std::string>& clients) { allowed_clients_ = clients; }
-    void set_denied_clients(const std::vector<std::string>& clients) { denied_clients_ = clients; }
+    void set_query_restriction_enabled(bool enabled);
+    void set_allowed_clients(const std::vector<std::string>& clients);
+    void set_denied_clients(const std::vector<std::string>& clients);
+    void set_rate_limiting_enabled(bool enabled) { enable_rate_limiting_ = enabled; }
+    void set_rate_limit_requests_per_minute(int requests) { rate_limit_requests_per_minute_ = requests; }
+    void set_rate_limit_burst_size(int size) { rate_limit_burst_size_ = size; }
+    void set_rate_limit_table_size(int size) { rate_limit_table_size_ = size; }
 
     // Performance Configuration
     int get_worker_threads() const { return worker_threads_; }
     int get_max_packet_size() const { return max_packet_size_; }
     bool is_statistics_enabled() const { return enable_statistics_; }
     int get_stats_interval() const { return stats_interval_; }
+    bool is_detailed_stats_enabled() const { return enable_detailed_stats_; }
+    int get_admin_port() const { return admin_port_; }
+    const std::string& get_admin_address() const { return admin_address_; }
+    const std::string& get_io_backend() const { return io_backend_; }
+    int get_event_batch_size() const { return event_batch_size_; }
+    bool is_so_reuseport_enabled() const { return enable_so_reuseport_; }
+    bool is_cpu_affinity_enabled() const { return enable_cpu_affinity_; }
+    bool is_udp_enabled() const { return enable_udp_; }
+    int get_udp_batch_size() const { return udp_batch_size_; }
+    bool is_ntp_enabled() const { return enable_ntp_; }
+    int get_ntp_port() const { return ntp_port_; }
+    bool is_kernel_timestamps_enabled() const { return enable_kernel_timestamps_; }
+    bool is_tx_timestamps_enabled() const { return enable_tx_timestamps_; }
+    bool is_reply_on_accept_enabled() const { return enable_reply_on_accept_; }
+    bool is_memory_pooling_enabled() const { return enable_memory_pooling_; }
+    int get_memory_pool_size() const { return memory_pool_size_; }
 
     void set_worker_threads(int threads) { worker_threads_ = threads; }
     void set_max_packet_size(int size) { max_packet_size_ = size; }
     void set_statistics_enabled(bool enabled) { enable_statistics_ = enabled; }
     void set_stats_interval(int interval) { stats_interval_ = interval; }
+    void set_detailed_stats_enabled(bool enabled) { enable_detailed_stats_ = enabled; }
+    void set_admin_port(int port) { admin_port_ = port; }
+    void set_admin_address(const std::string& address) { admin_address_ = address; }
+    void set_io_backend(const std::string& backend) { io_backend_ = backend; }
+    void set_event_batch_size(int size) { event_batch_size_ = size; }
+    void set_so_reuseport_enabled(bool enabled) { enable_so_reuseport_ = enabled; }
+    void set_cpu_affinity_enabled(bool enabled) { enable_cpu_affinity_ = enabled; }
+    void set_udp_enabled(bool enabled) { enable_udp_ = enabled; }
+    void set_udp_batch_size(int size) { udp_batch_size_ = size; }
+    void set_ntp_enabled(bool enabled) { enable_ntp_ = enabled; }
+    void set_ntp_port(int port) { ntp_port_ = port; }
+    void set_kernel_timestamps_enabled(bool enabled) { enable_kernel_timestamps_ = enabled; }
+    void set_tx_timestamps_enabled(bool enabled) { enable_tx_timestamps_ = enabled; }
+    void set_reply_on_accept_enabled(bool enabled) { enable_reply_on_accept_ = enabled; }
+    void set_memory_pooling_enabled(bool enabled) { enable_memory_pooling_ = enabled; }
+    void set_memory_pool_size(int size) { memory_pool_size_ = size; }
 
 private:
     // Network Configuration
@@ -99,6 +186,13 @@ private:
     int listen_port_;
     bool enable_ipv6_;
     int max_connections_;
+    int connection_timeout_;
+    CloseStrategy close_strategy_;
+    int close_wait_timeout_;
+    int listen_backlog_;
+    int socket_buffer_size_;
+    bool enable_tcp_fastopen_;
+    int tcp_fastopen_queue_size_;
 
     // UTC Server Configuration
     int stratum_;
@@ -107,12 +201,21 @@ private:
     std::vector<std::string> upstream_servers_;
     int sync_interval_;
     int timeout_;
+    int max_step_;
+    bool enable_upstream_sync_;
+    bool enable_shm_time_;
+    std::string shm_time_name_;
 
     // Logging Configuration
     std::string log_file_;
     std::string log_level_;
     bool enable_console_logging_;
     bool enable_syslog_;
+    bool log_async_;
+    int log_queue_size_;
+    int log_flush_interval_;
+    int log_flush_size_;
+    std::string log_overflow_policy_;
 
     // Security Configuration
     bool enable_authentication_;
@@ -120,14 +223,36 @@ private:
     bool restrict_queries_;
     std::vector<std::string> allowed_clients_;
     std::vector<std::string> denied_clients_;
+    std::shared_ptr<const AccessControl> access_control_;  // compiled from the three above
+    bool enable_rate_limiting_;
+    int rate_limit_requests_per_minute_;
+    int rate_limit_burst_size_;
+    int rate_limit_table_size_;
 
     // Performance Configuration
     int worker_threads_;
     int max_packet_size_;
     bool enable_statistics_;
     int stats_interval_;
+    bool enable_detailed_stats_;
+    int admin_port_;
+    std::string admin_address_;
+    std::string io_backend_;
+    int event_batch_size_;
+    bool enable_so_reuseport_;
+    bool enable_cpu_affinity_;
+    bool enable_udp_;
+    int udp_batch_size_;
+    bool enable_ntp_;
+    int ntp_port_;
+    bool enable_kernel_timestamps_;
+    bool enable_tx_timestamps_;
+    bool enable_reply_on_accept_;
+    bool enable_memory_pooling_;
+    int memory_pool_size_;
 
     void set_defaults();
+    void compile_access_control();
     bool parse_config_line(const std::string& line);
     std::string trim(const std::string& str);
     std::vector<std::string> parse_list(const std::string& str);
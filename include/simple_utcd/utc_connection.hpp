@@ -20,8 +20,14 @@
 
 #include <memory>
 #include <string>
-#include <atomic>
 #include "utc_packet.hpp"
+#include "timer_wheel.hpp"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <sys/socket.h>
+#endif
 
 namespace simple_utcd {
 
@@ -30,40 +36,73 @@ class Logger;
 
 class UTCConnection {
 public:
-    UTCConnection(int socket_fd, const std::string& client_address,
+    UTCConnection(int socket_fd, const struct sockaddr_storage& peer,
                   UTCConfig* config, Logger* logger);
     ~UTCConnection();
 
     bool is_connected() const { return connected_; }
-    const std::string& get_client_address() const { return client_address_; }
+    const struct sockaddr_storage& get_peer() const { return peer_; }
+    std::string get_client_address() const;
     int get_socket_fd() const { return socket_fd_; }
 
     bool send_packet(const UTCPacket& packet);
     bool receive_packet(UTCPacket& packet);
+
+    /**
+     * @brief Close the socket at once
+     *
+     * The graceful strategy's wait for the client's FIN is done beforehand by
+     * the event loop (start_close_wait()), and the abortive strategy's
+     * SO_LINGER is inherited from the listener, so nothing extra happens here.
+     * The descriptor is closed even when a failed send or receive already
+     * marked the connection as disconnected, and only once.
+     */
     void close_connection();
 
+    /**
+     * @brief Graceful close driven by an event loop: the reply is out, now wait for the client's FIN
+     */
+    void start_close_wait() { close_waiting_ = true; }
+    bool is_close_waiting() const { return close_waiting_; }
+
+    /**
+     * @brief Drain without blocking
+     * @return true once the client has closed its side or the connection failed
+     */
+    bool peer_closed();
+
     // Connection statistics
     int get_packets_sent() const { return packets_sent_; }
     int get_packets_received() const { return packets_received_; }
     int get_bytes_sent() const { return bytes_sent_; }
     int get_bytes_received() const { return bytes_received_; }
 
+    // Deadline hook for the owning worker's timer wheel
+    TimerWheel::Timer& deadline() { return deadline_; }
+
+    // Steady-clock nanoseconds at accept, set when latency is being measured
+    void set_accept_time(uint64_t nanoseconds) { accept_time_ = nanoseconds; }
+    uint64_t get_accept_time() const { return accept_time_; }
+
 private:
+    // A connection is owned by one thread at a time, so plain fields suffice;
+    // the address is only rendered to text when something logs it
     int socket_fd_;
-    std::string client_address_;
+    struct sockaddr_storage peer_;
     UTCConfig* config_;
     Logger* logger_;
 
-    std::atomic<bool> connected_;
-    std::atomic<int> packets_sent_;
-    std::atomic<int> packets_received_;
-    std::atomic<int> bytes_sent_;
-    std::atomic<int> bytes_received_;
+    bool connected_;
+    int packets_sent_;
+    int packets_received_;
+    int bytes_sent_;
+    int bytes_received_;
+    TimerWheel::Timer deadline_;
+    uint64_t accept_time_;
+    bool close_waiting_;
 
     bool send_data(const void* data, size_t size);
     bool receive_data(void* data, size_t size);
-    bool is_client_allowed() const;
-    bool is_client_denied() const;
 };
 
 } // namespace simple_utcd
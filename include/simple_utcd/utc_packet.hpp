@@ -18,6 +18,8 @@
 
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -26,6 +28,8 @@ namespace simple_utcd {
 
 class UTCPacket {
 public:
+    static constexpr size_t PACKET_SIZE = 4; // 32-bit timestamp in bytes
+
     UTCPacket();
     UTCPacket(uint32_t timestamp);
     ~UTCPacket();
@@ -34,6 +38,32 @@ public:
     bool from_bytes(const std::vector<uint8_t>& data);
     std::vector<uint8_t> to_bytes() const;
 
+    // Allocation-free variants used on the serving path
+    bool decode_from(const uint8_t* data, size_t size);
+    void encode_into(uint8_t* out) const { store_be32(timestamp_, out); }
+    std::array<uint8_t, PACKET_SIZE> to_array() const { return encode(timestamp_); }
+
+    // Network byte order (big-endian) helpers
+    static constexpr uint32_t load_be32(const uint8_t* data) {
+        return (static_cast<uint32_t>(data[0]) << 24) |
+               (static_cast<uint32_t>(data[1]) << 16) |
+               (static_cast<uint32_t>(data[2]) << 8) |
+               static_cast<uint32_t>(data[3]);
+    }
+
+    static constexpr void store_be32(uint32_t value, uint8_t* out) {
+        out[0] = static_cast<uint8_t>((value >> 24) & 0xFF);
+        out[1] = static_cast<uint8_t>((value >> 16) & 0xFF);
+        out[2] = static_cast<uint8_t>((value >> 8) & 0xFF);
+        out[3] = static_cast<uint8_t>(value & 0xFF);
+    }
+
+    static constexpr std::array<uint8_t, PACKET_SIZE> encode(uint32_t timestamp) {
+        std::array<uint8_t, PACKET_SIZE> data{};
+        store_be32(timestamp, data.data());
+        return data;
+    }
+
     // UTC time handling
     uint32_t get_timestamp() const { return timestamp_; }
     void set_timestamp(uint32_t timestamp) { timestamp_ = timestamp; }
@@ -44,16 +74,30 @@ public:
     static uint32_t string_to_timestamp(const std::string& time_str);
 
     // Validation
-    bool is_valid() const;
+    // Timestamps more than this far ahead of the reference time are rejected
+    static constexpr uint32_t FUTURE_TOLERANCE = 3600; // 1 hour in seconds
+
+    bool is_valid() const;  // against the cached server time
+    bool is_valid(uint32_t now) const { return validate_timestamp(timestamp_, now); }
     size_t get_packet_size() const;
 
+    static constexpr bool validate_timestamp(uint32_t timestamp, uint32_t now) {
+        return static_cast<uint64_t>(timestamp) <= static_cast<uint64_t>(now) + FUTURE_TOLERANCE;
+    }
+
+    /**
+     * @brief Validate a block of timestamps against one reference time
+     * @param results Optional per-entry verdicts, @p count entries long
+     * @return Number of valid timestamps
+     */
+    static size_t validate_many(const uint32_t* timestamps, size_t count, uint32_t now,
+                                bool* results = nullptr);
+
     // Debugging
     std::string to_string() const;
 
 private:
     uint32_t timestamp_;
-
-    bool validate_timestamp(uint32_t timestamp) const;
 };
 
 } // namespace simple_utcd
@@ -21,15 +21,28 @@
 #include <memory>
 #include <thread>
 #include <atomic>
-#include <vector>
+#include <condition_variable>
 #include <mutex>
+#include <vector>
 #include "utc_config.hpp"
 #include "logger.hpp"
+#include "mpmc_queue.hpp"
+#include "connection_pool.hpp"
+#include "server_stats.hpp"
+#include "latency_histogram.hpp"
+#include "snapshot.hpp"
 
 namespace simple_utcd {
 
 class UTCConnection;
 class UTCPacket;
+class EventLoop;
+class UDPBatch;
+class AccessControl;
+class RateLimiter;
+class TimeSynchronizer;
+class NTPResponder;
+class ShmPublisher;
 
 class UTCServer {
 public:
@@ -40,11 +53,42 @@ public:
     void stop();
     bool is_running() const { return running_; }
 
-    // Server statistics
-    int get_active_connections() const { return active_connections_; }
-    int get_total_connections() const { return total_connections_; }
-    int get_packets_sent() const { return packets_sent_; }
-    int get_packets_received() const { return packets_received_; }
+    /**
+     * @brief Apply the reloadable part of @p config while serving
+     *
+     * Access control, rate limits and connection_timeout are rebuilt into
+     * a new policy snapshot and published atomically; in-flight requests
+     * finish under the policy they started with. Settings tied to sockets,
+     * threads or the backend only take effect on restart and are reported.
+     */
+    bool reload(const UTCConfig& config);
+
+    // Server statistics; safe to call from any thread while serving
+    StatsSnapshot get_stats() const { return stats_->snapshot(); }
+    uint64_t get_active_connections() const { return get_stats().active_connections; }
+    uint64_t get_total_connections() const { return stats_->get(Counter::CONNECTIONS_ACCEPTED); }
+    uint64_t get_packets_sent() const { return stats_->get(Counter::PACKETS_SENT); }
+    uint64_t get_packets_received() const { return stats_->get(Counter::PACKETS_RECEIVED); }
+    uint64_t get_connections_denied() const { return stats_->get(Counter::CONNECTIONS_DENIED); }
+    uint64_t get_connections_timed_out() const { return stats_->get(Counter::CONNECTIONS_TIMED_OUT); }
+
+    // Merges every serving thread's histogram; all zero unless enable_detailed_stats is set
+    LatencySummary get_latency(LatencyMetric metric) const;
+
+    // One summary per serving thread (event loop workers or pool threads)
+    std::vector<LatencySummary> get_worker_latency(LatencyMetric metric) const;
+
+    // True while running and every TCP listening socket still accepts
+    bool is_listener_healthy() const;
+
+    // Connections accepted by each event loop worker (one entry per shard)
+    std::vector<uint64_t> get_shard_connection_counts() const;
+
+    // Requests dropped by the rate limiter, per limiter shard (empty when disabled)
+    std::vector<uint64_t> get_rate_limited_counts() const;
+
+    // Upstream sync state; null unless enable_upstream_sync is set
+    const TimeSynchronizer* get_synchronizer() const { return synchronizer_.get(); }
 
     // Configuration access
     UTCConfig* get_config() const { return config_; }
@@ -54,24 +98,95 @@ private:
     UTCConfig* config_;
     Logger* logger_;
 
+    // Per-thread event loop state for the epoll backend
+    struct Worker;
+
     std::atomic<bool> running_;
-    std::vector<std::unique_ptr<UTCConnection>> connections_;
+    bool use_event_loop_;
+    bool use_io_uring_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::unique_ptr<ConnectionPool> connection_pool_;  // threaded backend; outlives the queue
+    std::unique_ptr<MPMCQueue<ConnectionPtr>> connection_queue_;
     std::vector<std::thread> worker_threads_;
-    std::mutex connections_mutex_;
+    std::thread accept_thread_;
+    std::thread udp_thread_;
+
+    // What reload() may change; the serving threads pin it without locks
+    struct Policy;
+    std::unique_ptr<SnapshotCell<Policy>> policy_;
+    mutable std::mutex policy_mutex_;  // serializes reload() and readers off the serving path
+    size_t limiter_shards_;
+    std::unique_ptr<TimeSynchronizer> synchronizer_;
+    std::unique_ptr<NTPResponder> ntp_responder_;
+    std::unique_ptr<ShmPublisher> shm_publisher_;
 
     // Statistics
-    std::atomic<int> active_connections_;
-    std::atomic<int> total_connections_;
-    std::atomic<int> packets_sent_;
-    std::atomic<int> packets_received_;
+    std::unique_ptr<ServerStats> stats_;
+    std::thread stats_thread_;
+    std::mutex stats_mutex_;
+    std::condition_variable stats_cv_;
+    bool detailed_stats_;
+    std::vector<std::unique_ptr<LatencySet>> thread_latency_;  // threaded backend, one per worker and the udp thread
 
-    // Server socket
+    // Kernel datagram timestamps: arrival on both UDP paths, transmit on the NTP socket
+    bool kernel_timestamps_;
+    bool tx_timestamps_;
+
+    // How TCP connections are closed after the reply; see close_strategy in the docs
+    CloseStrategy close_strategy_;
+
+    // Write the reply from the accepting thread instead of a later event or a worker
+    bool reply_on_accept_;
+    enum class AcceptReply { SENT, DEFERRED, FAILED };
+
+    // Server sockets
     int server_socket_;
+    int udp_socket_;
+    int ntp_socket_;
+
+    // Threaded backend: one blocking acceptor feeding a shared queue
+    void accept_connections(LatencySet* latency);
+    void handle_connection(ConnectionPtr connection, LatencySet* latency);
+    void worker_thread_main(LatencySet* latency);
+
+    // Event loop backend: every worker accepts and replies on its own loop
+    void event_loop_main(Worker* worker);
+    void accept_ready(Worker* worker, const Policy& policy);
+    void connection_ready(Worker* worker, UTCConnection* connection, uint32_t events);
+    void expire_connection(Worker* worker, UTCConnection* connection);
+    void release_connection(Worker* worker, UTCConnection* connection);
+    bool shed_connection(Worker* worker);
+    bool send_time(UTCConnection* connection, LatencySet* latency);
+    AcceptReply reply_on_accept(int client_fd, const uint8_t* reply, uint64_t accept_ns, LatencySet* latency);
+    void begin_close_wait(Worker* worker, UTCConnection* connection, bool registered);
+
+    // io_uring backend: multishot accept, then a linked write and close per connection
+    void uring_main(Worker* worker);
+    void uring_accepted(Worker* worker, int client_fd, const Policy& policy);
+
+    // RFC 868 over UDP: batched receive, one timestamp per batch or per kernel arrival stamp
+    void udp_thread_main(LatencySet* latency);
+    void serve_udp(int socket_fd, UDPBatch& batch, const Policy& policy);
+    bool admit_datagram(const Policy& policy, const struct sockaddr_storage& peer, uint64_t now_ns);
+
+    // SNTP/NTPv4 on the same batched path, replies built over the requests
+    void serve_ntp(int socket_fd, UDPBatch& batch, LatencySet* latency, const Policy& policy);
+    void collect_transmit_timestamps(int socket_fd, LatencySet* latency);
+
+    // Periodic summary line (enable_statistics / stats_interval)
+    void stats_thread_main();
+    void log_stats(const StatsSnapshot& current, const StatsSnapshot& previous, double seconds);
+
+    std::unique_ptr<const Policy> make_policy(const UTCConfig& config, const Policy* previous) const;
+
+    size_t pool_capacity(int pools) const;
+    ConnectionPtr make_connection(ConnectionPool* pool, int client_fd, const struct sockaddr_storage& peer);
 
-    void accept_connections();
-    void handle_connection(std::unique_ptr<UTCConnection> connection);
-    void worker_thread_main();
     bool create_server_socket();
+    int open_socket(int type, int port, struct sockaddr_storage& address, size_t& length);
+    int open_listener(bool reuse_port);
+    int open_udp_socket(int port, bool reuse_port, bool transmit_timestamps);
+    void set_socket_buffers(int fd);
     void close_server_socket();
 
     // UTC time handling
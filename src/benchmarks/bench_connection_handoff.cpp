@@ -0,0 +1,199 @@
+/*
+ * src/benchmarks/bench_connection_handoff.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Acceptor-to-worker handoff on the threads backend: the MPMC ring against
+ * the vector the server used before it (push_back under a mutex, workers
+ * erase the front and sleep 10 ms when it is empty).
+ *
+ * One producer stands in for the acceptor and hands over heap-allocated
+ * connection records, like the server's unique_ptr<UTCConnection>.
+ * Two runs per queue:
+ *   - burst: push ITEMS as fast as the queue takes them, with at most
+ *     CAPACITY in flight as max_connections allows, report items/s
+ *   - paced: push one item every PACE_US, report push-to-pop latency
+ *
+ * Usage: bench_connection_handoff [workers]
+ */
+
+#include "simple_utcd/mpmc_queue.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace simple_utcd;
+
+namespace {
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+constexpr size_t ITEMS = 1000000;
+constexpr size_t PACED_ITEMS = 20000;
+constexpr int PACE_US = 50;
+constexpr size_t CAPACITY = 1024;  // default max_connections
+
+struct Record {
+    uint64_t pushed_ns;
+};
+
+using RecordPtr = std::unique_ptr<Record>;
+
+// The handoff the threads backend had before the ring
+class VectorHandoff {
+public:
+    bool push(RecordPtr& record) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        records_.push_back(std::move(record));
+        return true;
+    }
+
+    bool pop(RecordPtr& record) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!records_.empty()) {
+                record = std::move(records_.front());
+                records_.erase(records_.begin());
+                return true;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        return false;
+    }
+
+    void wake() {}
+
+private:
+    std::mutex mutex_;
+    std::vector<RecordPtr> records_;
+};
+
+class RingHandoff {
+public:
+    RingHandoff() : queue_(CAPACITY) {}
+
+    bool push(RecordPtr& record) { return queue_.try_push(record); }
+    bool pop(RecordPtr& record) { return queue_.pop_wait(record, std::chrono::milliseconds(100)); }
+    void wake() { queue_.notify_all(); }
+
+private:
+    MPMCQueue<RecordPtr> queue_;
+};
+
+struct Result {
+    double seconds = 0;
+    uint64_t p50_ns = 0;
+    uint64_t p99_ns = 0;
+    uint64_t max_ns = 0;
+};
+
+template<typename Handoff>
+Result run(int workers, size_t items, int pace_us) {
+    Handoff handoff;
+    std::atomic<size_t> consumed{0};
+    std::atomic<bool> done{false};
+    // Each worker keeps its own samples; reserved up front so recording never allocates
+    std::vector<std::vector<uint64_t>> samples(static_cast<size_t>(workers));
+    std::vector<std::thread> threads;
+
+    for (int w = 0; w < workers; ++w) {
+        std::vector<uint64_t>* latencies = &samples[static_cast<size_t>(w)];
+        latencies->reserve(items);
+        threads.emplace_back([&handoff, &consumed, &done, latencies] {
+            while (!done.load(std::memory_order_acquire)) {
+                RecordPtr record;
+                if (handoff.pop(record)) {
+                    latencies->push_back(now_ns() - record->pushed_ns);
+                    consumed.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto next = start;
+    for (size_t i = 0; i < items; ++i) {
+        if (pace_us > 0) {
+            next += std::chrono::microseconds(pace_us);
+            while (std::chrono::steady_clock::now() < next) {
+            }
+        }
+        // max_connections bounds both queues: the producer waits instead of rejecting,
+        // so every item is moved and the vector never grows past CAPACITY
+        while (i - consumed.load(std::memory_order_relaxed) >= CAPACITY) {
+            std::this_thread::yield();
+        }
+        RecordPtr record(new Record{now_ns()});
+        while (!handoff.push(record)) {
+            std::this_thread::yield();
+        }
+    }
+    while (consumed.load(std::memory_order_relaxed) < items) {
+        std::this_thread::yield();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    done.store(true, std::memory_order_release);
+    handoff.wake();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<uint64_t> merged;
+    for (const auto& latencies : samples) {
+        merged.insert(merged.end(), latencies.begin(), latencies.end());
+    }
+    std::sort(merged.begin(), merged.end());
+
+    Result result;
+    result.seconds = std::chrono::duration<double>(end - start).count();
+    if (!merged.empty()) {
+        result.p50_ns = merged[merged.size() / 2];
+        result.p99_ns = merged[merged.size() * 99 / 100];
+        result.max_ns = merged.back();
+    }
+    return result;
+}
+
+void report(const char* name, const Result& burst, const Result& paced) {
+    std::printf("%-7s burst %10.0f items/s   paced p50 %9.1f us  p99 %9.1f us  max %9.1f us\n",
+                name, ITEMS / burst.seconds,
+                paced.p50_ns / 1000.0, paced.p99_ns / 1000.0, paced.max_ns / 1000.0);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int workers = argc > 1 ? std::max(1, std::atoi(argv[1])) : 4;
+    std::setvbuf(stdout, nullptr, _IOLBF, 0);
+    std::printf("%d workers, burst of %zu, paced %zu at one per %d us, ring capacity %zu\n",
+                workers, ITEMS, PACED_ITEMS, PACE_US, CAPACITY);
+
+    report("ring", run<RingHandoff>(workers, ITEMS, 0), run<RingHandoff>(workers, PACED_ITEMS, PACE_US));
+    report("vector", run<VectorHandoff>(workers, ITEMS, 0), run<VectorHandoff>(workers, PACED_ITEMS, PACE_US));
+    return 0;
+}
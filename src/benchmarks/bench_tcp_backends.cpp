@@ -0,0 +1,287 @@
+/*
+ * src/benchmarks/bench_tcp_backends.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * RFC 868 over TCP on loopback, one backend at a time: requests per second
+ * and the server's syscalls and CPU time per request.
+ *
+ * Each backend runs a UTCServer in a forked child so that its syscalls can
+ * be counted apart from the load generator's. The count uses the
+ * raw_syscalls:sys_enter tracepoint through perf_event_open, which needs
+ * tracefs and perf_event_paranoid <= 1 (or CAP_PERFMON); without them only
+ * the CPU time is reported. Both numbers include the server's idle threads
+ * (ticker, statistics), which is noise at these request rates.
+ *
+ * Usage: bench_tcp_backends [seconds] [clients] [workers] [backend...]
+ * Default: 3 s, 4 client threads, 1 server worker, epoll and io_uring.
+ */
+
+#include "simple_utcd/logger.hpp"
+#include "simple_utcd/uring_loop.hpp"
+#include "simple_utcd/utc_config.hpp"
+#include "simple_utcd/utc_server.hpp"
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <linux/perf_event.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <string>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace simple_utcd;
+
+namespace {
+
+constexpr int BASE_PORT = 23700;
+
+struct Options {
+    int seconds = 3;
+    int clients = 4;
+    int workers = 1;
+    std::vector<std::string> backends;
+};
+
+// Tracepoint id of raw_syscalls:sys_enter, or -1 without tracefs
+long syscall_tracepoint() {
+    for (const char* path : {"/sys/kernel/tracing/events/raw_syscalls/sys_enter/id",
+                             "/sys/kernel/debug/tracing/events/raw_syscalls/sys_enter/id"}) {
+        std::ifstream file(path);
+        long id;
+        if (file >> id) {
+            return id;
+        }
+    }
+    return -1;
+}
+
+// Counts every syscall of @p pid and the threads it creates afterwards
+int open_syscall_counter(pid_t pid) {
+    long id = syscall_tracepoint();
+    if (id < 0) {
+        return -1;
+    }
+    struct perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_TRACEPOINT;
+    attr.config = static_cast<uint64_t>(id);
+    attr.disabled = 1;
+    attr.inherit = 1;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, pid, -1, -1, 0));
+}
+
+// utime + stime of @p pid in clock ticks
+long cpu_ticks(pid_t pid) {
+    std::ifstream file("/proc/" + std::to_string(pid) + "/stat");
+    std::string stat((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    // Fields after the parenthesized command name; utime and stime are the 12th and 13th
+    size_t pos = stat.rfind(')');
+    if (pos == std::string::npos) {
+        return 0;
+    }
+    std::vector<std::string> fields;
+    size_t start = pos + 2;
+    while (start < stat.size()) {
+        size_t end = stat.find(' ', start);
+        if (end == std::string::npos) {
+            end = stat.size();
+        }
+        fields.push_back(stat.substr(start, end - start));
+        start = end + 1;
+    }
+    return fields.size() > 12 ? std::atol(fields[11].c_str()) + std::atol(fields[12].c_str()) : 0;
+}
+
+[[noreturn]] void run_server(const std::string& backend, int port, int workers, int go_fd, int ready_fd) {
+    char byte;
+    if (read(go_fd, &byte, 1) != 1) {
+        _exit(1);
+    }
+
+    UTCConfig config;
+    config.set_listen_address("127.0.0.1");
+    config.set_listen_port(port);
+    config.set_ipv6_enabled(false);
+    config.set_io_backend(backend);
+    config.set_worker_threads(workers);
+    config.set_max_connections(4096);
+    config.set_udp_enabled(false);
+    config.set_ntp_enabled(false);
+    config.set_stats_interval(3600);
+
+    Logger logger;
+    logger.set_level(LogLevel::ERROR);
+    signal(SIGPIPE, SIG_IGN);
+
+    UTCServer server(&config, &logger);
+    byte = server.start() ? 1 : 0;
+    if (write(ready_fd, &byte, 1) != 1 || !byte) {
+        _exit(1);
+    }
+
+    // The parent closes its end when the run is over
+    while (read(go_fd, &byte, 1) > 0) {
+    }
+    server.stop();
+    _exit(0);
+}
+
+// One request: connect, read the 4-byte reply, close
+bool request(const struct sockaddr_in& address) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = connect(fd, reinterpret_cast<const struct sockaddr*>(&address), sizeof(address)) == 0;
+    uint8_t reply[4];
+    size_t received = 0;
+    while (ok && received < sizeof(reply)) {
+        ssize_t result = recv(fd, reply + received, sizeof(reply) - received, 0);
+        ok = result > 0;
+        received += ok ? static_cast<size_t>(result) : 0;
+    }
+    close(fd);
+    return ok;
+}
+
+void bench(const Options& options, const std::string& backend, int port) {
+    if (backend == "io_uring" && !UringLoop::is_supported()) {
+        std::printf("%-9s skipped: built without liburing or kernel older than 5.19\n", backend.c_str());
+        return;
+    }
+
+    int go[2], ready[2];
+    if (pipe(go) != 0 || pipe(ready) != 0) {
+        std::perror("pipe");
+        return;
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(go[1]);
+        close(ready[0]);
+        run_server(backend, port, options.workers, go[0], ready[1]);
+    }
+    close(go[0]);
+    close(ready[1]);
+
+    // Opened before the server creates its threads so that all of them are counted
+    int counter = open_syscall_counter(pid);
+    char byte = 1;
+    if (write(go[1], &byte, 1) != 1 || read(ready[0], &byte, 1) != 1 || !byte) {
+        std::printf("%-9s failed to start\n", backend.c_str());
+        close(go[1]);
+        waitpid(pid, nullptr, 0);
+        return;
+    }
+
+    struct sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> completed{0};
+    std::atomic<uint64_t> failed{0};
+
+    long ticks_before = cpu_ticks(pid);
+    if (counter >= 0) {
+        ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+        ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> clients;
+    for (int c = 0; c < options.clients; ++c) {
+        clients.emplace_back([&] {
+            while (!done.load(std::memory_order_relaxed)) {
+                (request(address) ? completed : failed).fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::seconds(options.seconds));
+    done.store(true);
+    for (auto& client : clients) {
+        client.join();
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    uint64_t syscalls = 0;
+    if (counter >= 0) {
+        ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(counter, &syscalls, sizeof(syscalls)) != sizeof(syscalls)) {
+            syscalls = 0;
+        }
+        close(counter);
+    }
+    long ticks = cpu_ticks(pid) - ticks_before;
+
+    close(go[1]);
+    waitpid(pid, nullptr, 0);
+
+    uint64_t requests = completed.load();
+    double per_request = requests ? 1.0 / static_cast<double>(requests) : 0;
+    std::printf("%-9s %10.0f req/s  %8.3f ms CPU/1k req  ", backend.c_str(), requests / elapsed,
+                ticks * 1000.0 / sysconf(_SC_CLK_TCK) * 1000.0 * per_request);
+    if (counter >= 0) {
+        std::printf("%6.2f syscalls/req", syscalls * per_request);
+    } else {
+        std::printf("  syscalls n/a");
+    }
+    std::printf("  (%llu failed)\n", static_cast<unsigned long long>(failed.load()));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (argc > 1) {
+        options.seconds = std::max(1, std::atoi(argv[1]));
+    }
+    if (argc > 2) {
+        options.clients = std::max(1, std::atoi(argv[2]));
+    }
+    if (argc > 3) {
+        options.workers = std::max(1, std::atoi(argv[3]));
+    }
+    for (int i = 4; i < argc; ++i) {
+        options.backends.push_back(argv[i]);
+    }
+    if (options.backends.empty()) {
+        options.backends = {"epoll", "io_uring"};
+    }
+
+    std::setvbuf(stdout, nullptr, _IOLBF, 0);
+    std::printf("%d s per backend, %d clients, %d server workers%s\n", options.seconds, options.clients,
+                options.workers, syscall_tracepoint() < 0 ? ", no tracefs: syscalls not counted" : "");
+    for (size_t i = 0; i < options.backends.size(); ++i) {
+        bench(options, options.backends[i], BASE_PORT + static_cast<int>(i));
+    }
+    return 0;
+}
@@ -0,0 +1,168 @@
+/*
+ * src/core/access_control.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simple_utcd/access_control.hpp"
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#endif
+
+namespace simple_utcd {
+
+namespace {
+
+// ::ffff:a.b.c.d
+bool is_v4_mapped(const uint8_t* bytes) {
+    static const uint8_t prefix[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff};
+    return memcmp(bytes, prefix, sizeof(prefix)) == 0;
+}
+
+} // namespace
+
+AccessControl::AccessControl(const std::vector<std::string>& allowed_clients,
+                             const std::vector<std::string>& denied_clients,
+                             bool restrict_queries)
+    : v4_(1)
+    , v6_(1)
+    , check_allow_list_(restrict_queries && !allowed_clients.empty())
+    , rule_count_(0)
+{
+    // An allow list whose entries are all invalid still restricts: fail closed
+    for (const auto& rule : denied_clients) {
+        add_rule(rule, RULE_DENY);
+    }
+    if (check_allow_list_) {
+        for (const auto& rule : allowed_clients) {
+            add_rule(rule, RULE_ALLOW);
+        }
+    }
+}
+
+bool AccessControl::is_allowed(const struct sockaddr_storage& address) const {
+    return is_allowed(reinterpret_cast<const struct sockaddr*>(&address));
+}
+
+bool AccessControl::is_allowed(const struct sockaddr* address) const {
+    if (address->sa_family == AF_INET) {
+        const auto* in = reinterpret_cast<const struct sockaddr_in*>(address);
+        return check(reinterpret_cast<const uint8_t*>(&in->sin_addr), 32);
+    }
+    if (address->sa_family == AF_INET6) {
+        const auto* in6 = reinterpret_cast<const struct sockaddr_in6*>(address);
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&in6->sin6_addr);
+        if (is_v4_mapped(bytes)) {
+            return check(bytes + 12, 32);
+        }
+        return check(bytes, 128);
+    }
+
+    // Unknown families only get through when nothing is being filtered
+    return !is_filtering();
+}
+
+bool AccessControl::check(const uint8_t* bytes, int bits) const {
+    uint8_t rules = match(bits == 32 ? v4_ : v6_, bytes, bits);
+    if (rules & RULE_DENY) {
+        return false;
+    }
+    return !check_allow_list_ || (rules & RULE_ALLOW);
+}
+
+bool AccessControl::add_rule(const std::string& rule, uint8_t kind) {
+    std::string address = rule;
+    int prefix_length = -1;
+
+    size_t slash = rule.find('/');
+    if (slash != std::string::npos) {
+        address = rule.substr(0, slash);
+        const char* digits = rule.c_str() + slash + 1;
+        char* end = nullptr;
+        long value = strtol(digits, &end, 10);
+        if (end == digits || *end != '\0' || value < 0) {
+            invalid_rules_.push_back(rule);
+            return false;
+        }
+        prefix_length = static_cast<int>(value);
+    }
+
+    uint8_t bytes[16];
+    if (inet_pton(AF_INET, address.c_str(), bytes) == 1) {
+        if (prefix_length > 32) {
+            invalid_rules_.push_back(rule);
+            return false;
+        }
+        insert(v4_, bytes, prefix_length < 0 ? 32 : prefix_length, kind);
+    } else if (inet_pton(AF_INET6, address.c_str(), bytes) == 1) {
+        if (prefix_length > 128) {
+            invalid_rules_.push_back(rule);
+            return false;
+        }
+        if (prefix_length < 0) {
+            prefix_length = 128;
+        }
+        // Mapped rules land in the IPv4 trie so they match plain IPv4 peers too
+        if (is_v4_mapped(bytes) && prefix_length >= 96) {
+            insert(v4_, bytes + 12, prefix_length - 96, kind);
+        } else {
+            insert(v6_, bytes, prefix_length, kind);
+        }
+    } else {
+        invalid_rules_.push_back(rule);
+        return false;
+    }
+
+    rule_count_++;
+    return true;
+}
+
+void AccessControl::insert(std::vector<Node>& trie, const uint8_t* bytes, int prefix_length, uint8_t kind) {
+    uint32_t node = 0;
+    for (int i = 0; i < prefix_length; ++i) {
+        int bit = (bytes[i >> 3] >> (7 - (i & 7))) & 1;
+        if (trie[node].child[bit] == 0) {
+            trie[node].child[bit] = static_cast<uint32_t>(trie.size());
+            trie.emplace_back();
+        }
+        node = trie[node].child[bit];
+    }
+    trie[node].rules |= kind;
+}
+
+uint8_t AccessControl::match(const std::vector<Node>& trie, const uint8_t* bytes, int bits) {
+    // Collect every rule on the path; any matching prefix counts, not just the longest
+    uint32_t node = 0;
+    uint8_t rules = trie[0].rules;
+    for (int i = 0; i < bits; ++i) {
+        int bit = (bytes[i >> 3] >> (7 - (i & 7))) & 1;
+        node = trie[node].child[bit];
+        if (node == 0) {
+            break;
+        }
+        rules |= trie[node].rules;
+    }
+    return rules;
+}
+
+} // namespace simple_utcd
@@ -0,0 +1,368 @@
+/*
+ * src/core/admin_server.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simple_utcd/admin_server.hpp"
+#include "simple_utcd/utc_server.hpp"
+#include "simple_utcd/utc_config.hpp"
+#include "simple_utcd/logger.hpp"
+#include "simple_utcd/platform.hpp"
+#include "simple_utcd/error_handler.hpp"
+#include "simple_utcd/time_source.hpp"
+#include "simple_utcd/time_synchronizer.hpp"
+#include <cstring>
+#include <sstream>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <poll.h>
+#endif
+
+namespace simple_utcd {
+
+namespace {
+
+// Requests larger than this are rejected; the admin API only takes bare GETs
+constexpr size_t MAX_REQUEST_SIZE = 4096;
+
+const char* metric_name(LatencyMetric metric) {
+    switch (metric) {
+        case LatencyMetric::ACCEPT_TO_SEND: return "accept_to_send";
+        case LatencyMetric::SEND_SYSCALL: return "send";
+        case LatencyMetric::QUEUE_WAIT: return "queue_wait";
+        case LatencyMetric::NTP_RESIDENCE: return "ntp_residence";
+        default: return "unknown";
+    }
+}
+
+const char* severity_name(ErrorSeverity severity) {
+    switch (severity) {
+        case ErrorSeverity::INFO: return "info";
+        case ErrorSeverity::WARNING: return "warning";
+        case ErrorSeverity::ERROR: return "error";
+        case ErrorSeverity::CRITICAL: return "critical";
+        default: return "unknown";
+    }
+}
+
+void write_header(std::ostringstream& out, const char* name, const char* type, const char* help) {
+    out << "# HELP " << name << " " << help << "\n";
+    out << "# TYPE " << name << " " << type << "\n";
+}
+
+void write_summary(std::ostringstream& out, const std::string& labels, const LatencySummary& summary) {
+    const char* separator = labels.empty() ? "" : ",";
+    out << "simple_utcd_latency_seconds{" << labels << separator << "quantile=\"0.5\"} " << summary.p50 / 1e9 << "\n";
+    out << "simple_utcd_latency_seconds{" << labels << separator << "quantile=\"0.99\"} " << summary.p99 / 1e9 << "\n";
+    out << "simple_utcd_latency_seconds{" << labels << separator << "quantile=\"0.999\"} " << summary.p999 / 1e9 << "\n";
+    out << "simple_utcd_latency_seconds_sum{" << labels << "} " << summary.sum / 1e9 << "\n";
+    out << "simple_utcd_latency_seconds_count{" << labels << "} " << summary.count << "\n";
+}
+
+bool send_all(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        auto result = send(fd, data.data() + sent, data.size() - sent, 0);
+        if (result <= 0) {
+            return false;
+        }
+        sent += static_cast<size_t>(result);
+    }
+    return true;
+}
+
+// A HEAD response carries the headers, Content-Length included, but never the body
+void send_response(int fd, int status, const char* reason, const char* content_type, const std::string& body,
+                   bool head = false) {
+    std::ostringstream response;
+    response << "HTTP/1.1 " << status << " " << reason << "\r\n"
+             << "Content-Type: " << content_type << "\r\n"
+             << "Content-Length: " << body.size() << "\r\n"
+             << "Connection: close\r\n\r\n";
+    if (!head) {
+        response << body;
+    }
+    send_all(fd, response.str());
+}
+
+} // namespace
+
+AdminServer::AdminServer(UTCServer* server, UTCConfig* config, Logger* logger)
+    : server_(server)
+    , config_(config)
+    , logger_(logger)
+    , running_(false)
+    , listen_fd_(-1)
+{
+}
+
+AdminServer::~AdminServer() {
+    stop();
+}
+
+bool AdminServer::start() {
+    if (running_) {
+        return false;
+    }
+
+    struct sockaddr_storage address;
+    size_t length;
+    if (!Platform::resolve_address(config_->get_admin_address(), config_->get_admin_port(),
+                                   config_->is_ipv6_enabled(), address, length)) {
+        UTC_ERROR("AdminServer", "Failed to resolve admin address: " + Platform::get_last_error());
+        return false;
+    }
+
+    listen_fd_ = Platform::create_socket(address.ss_family, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+        UTC_ERROR("AdminServer", "Failed to create admin socket: " + Platform::get_last_error());
+        return false;
+    }
+
+    int reuse = 1;
+    Platform::set_socket_option(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (address.ss_family == AF_INET6) {
+        Platform::set_dual_stack(listen_fd_);
+    }
+
+    if (!Platform::bind_socket(listen_fd_, address, length) ||
+        !Platform::listen_socket(listen_fd_, 16)) {
+        UTC_ERROR("AdminServer", "Failed to open admin listener: " + Platform::get_last_error());
+        Platform::close_socket(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    running_ = true;
+    thread_ = std::thread(&AdminServer::thread_main, this);
+
+    if (logger_) {
+        logger_->info("Admin endpoint listening on {}:{} (/metrics, /healthz)",
+                     config_->get_admin_address(), config_->get_admin_port());
+    }
+    return true;
+}
+
+void AdminServer::stop() {
+    if (!running_) {
+        return;
+    }
+
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    Platform::close_socket(listen_fd_);
+    listen_fd_ = -1;
+}
+
+void AdminServer::thread_main() {
+    while (running_) {
+        struct pollfd pfd;
+        pfd.fd = listen_fd_;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        // Bounded wait so stop() is noticed without closing the socket under us
+        if (poll(&pfd, 1, 200) <= 0) {
+            continue;
+        }
+
+        struct sockaddr_storage client_address;
+        int client_fd = Platform::accept_connection(listen_fd_, &client_address);
+        if (client_fd < 0) {
+            continue;
+        }
+        handle_client(client_fd);
+        Platform::close_socket(client_fd);
+    }
+}
+
+void AdminServer::handle_client(int client_fd) {
+    // A slow or idle client must not wedge the admin thread
+    struct timeval timeout;
+    timeout.tv_sec = 2;
+    timeout.tv_usec = 0;
+    Platform::set_socket_option(client_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    Platform::set_socket_option(client_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    // Read until the end of the request head
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < MAX_REQUEST_SIZE) {
+        auto received = recv(client_fd, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            return;
+        }
+        request.append(buffer, static_cast<size_t>(received));
+    }
+
+    // Request line: METHOD SP PATH SP VERSION
+    size_t line_end = request.find("\r\n");
+    std::istringstream line(request.substr(0, line_end));
+    std::string method, target, version;
+    line >> method >> target >> version;
+
+    size_t query = target.find('?');
+    std::string path = target.substr(0, query);
+
+    bool head = method == "HEAD";
+    if (method != "GET" && !head) {
+        send_response(client_fd, 405, "Method Not Allowed", "text/plain", "method not allowed\n");
+    } else if (path == "/metrics") {
+        send_response(client_fd, 200, "OK", "text/plain; version=0.0.4", render_metrics(), head);
+    } else if (path == "/healthz") {
+        std::string body;
+        if (render_health(body)) {
+            send_response(client_fd, 200, "OK", "text/plain", body, head);
+        } else {
+            send_response(client_fd, 503, "Service Unavailable", "text/plain", body, head);
+        }
+    } else {
+        send_response(client_fd, 404, "Not Found", "text/plain", "not found\n", head);
+    }
+}
+
+bool AdminServer::render_health(std::string& body) const {
+    bool listener = server_->is_listener_healthy();
+    bool ticker = TimeSource::instance().is_ticker_healthy();
+
+    body = std::string("listener: ") + (listener ? "ok" : "down") + "\n" +
+           "ticker: " + (ticker ? "ok" : "down") + "\n";
+    return listener && ticker;
+}
+
+std::string AdminServer::render_metrics() const {
+    std::ostringstream out;
+    // Latency sums grow without bound; the default six digits would flatten their rate
+    out.precision(15);
+    StatsSnapshot stats = server_->get_stats();
+
+    write_header(out, "simple_utcd_info", "gauge", "Static configuration of this instance");
+    out << "simple_utcd_info{io_backend=\"" << config_->get_io_backend()
+        << "\",listen_address=\"" << config_->get_listen_address()
+        << "\",listen_port=\"" << config_->get_listen_port()
+        << "\",worker_threads=\"" << config_->get_worker_threads()
+        << "\",udp=\"" << (config_->is_udp_enabled() ? "true" : "false") << "\"} 1\n";
+
+    write_header(out, "simple_utcd_up", "gauge", "Whether the server is running");
+    out << "simple_utcd_up " << (server_->is_running() ? 1 : 0) << "\n";
+
+    write_header(out, "simple_utcd_ticker_healthy", "gauge", "Whether the cached time cell is being refreshed on schedule");
+    out << "simple_utcd_ticker_healthy " << (TimeSource::instance().is_ticker_healthy() ? 1 : 0) << "\n";
+
+    if (const TimeSynchronizer* synchronizer = server_->get_synchronizer()) {
+        write_header(out, "simple_utcd_sync_synchronized", "gauge", "Whether an upstream offset estimate exists");
+        out << "simple_utcd_sync_synchronized " << (synchronizer->is_synchronized() ? 1 : 0) << "\n";
+        write_header(out, "simple_utcd_sync_offset_seconds", "gauge", "Correction applied to the system clock for served time");
+        out << "simple_utcd_sync_offset_seconds " << synchronizer->get_offset_ns() / 1e9 << "\n";
+        write_header(out, "simple_utcd_sync_upstreams_reachable", "gauge", "Upstreams that answered the last round");
+        out << "simple_utcd_sync_upstreams_reachable " << synchronizer->get_reachable() << "\n";
+    }
+
+    write_header(out, "simple_utcd_connections_accepted_total", "counter", "TCP connections accepted");
+    out << "simple_utcd_connections_accepted_total " << stats.total_connections << "\n";
+
+    write_header(out, "simple_utcd_connections_active", "gauge", "TCP connections currently open");
+    out << "simple_utcd_connections_active " << stats.active_connections << "\n";
+
+    write_header(out, "simple_utcd_connections_denied_total", "counter", "Connections and datagrams refused by the access control list");
+    out << "simple_utcd_connections_denied_total " << stats.connections_denied << "\n";
+
+    write_header(out, "simple_utcd_connections_rejected_total", "counter", "TCP connections closed unserved by the rate limiter or a capacity limit");
+    out << "simple_utcd_connections_rejected_total " << stats.connections_rejected << "\n";
+
+    write_header(out, "simple_utcd_connections_timed_out_total", "counter", "TCP connections reaped by connection_timeout");
+    out << "simple_utcd_connections_timed_out_total " << stats.connections_timed_out << "\n";
+
+    write_header(out, "simple_utcd_accept_failures_total", "counter", "accept() errors such as descriptor exhaustion");
+    out << "simple_utcd_accept_failures_total " << stats.accept_failures << "\n";
+
+    write_header(out, "simple_utcd_packets_sent_total", "counter", "Time replies sent over TCP and UDP");
+    out << "simple_utcd_packets_sent_total " << stats.packets_sent << "\n";
+
+    write_header(out, "simple_utcd_packets_received_total", "counter", "Datagrams received");
+    out << "simple_utcd_packets_received_total " << stats.packets_received << "\n";
+
+    TcpSocketStats tcp;
+    if (Platform::read_tcp_socket_stats(tcp)) {
+        write_header(out, "simple_utcd_tcp_time_wait_sockets", "gauge", "Host TCP sockets in TIME_WAIT");
+        out << "simple_utcd_tcp_time_wait_sockets " << tcp.time_wait << "\n";
+
+        write_header(out, "simple_utcd_tcp_orphaned_sockets", "gauge", "Host TCP sockets closed by their process but not yet released");
+        out << "simple_utcd_tcp_orphaned_sockets " << tcp.orphaned << "\n";
+
+        write_header(out, "simple_utcd_tcp_memory_bytes", "gauge", "Host memory held by TCP socket buffers");
+        out << "simple_utcd_tcp_memory_bytes " << tcp.memory_bytes << "\n";
+    }
+
+    std::vector<uint64_t> shards = server_->get_shard_connection_counts();
+    if (!shards.empty()) {
+        write_header(out, "simple_utcd_worker_connections_accepted_total", "counter", "TCP connections accepted per event loop worker");
+        for (size_t i = 0; i < shards.size(); ++i) {
+            out << "simple_utcd_worker_connections_accepted_total{worker=\"" << i << "\"} " << shards[i] << "\n";
+        }
+    }
+
+    std::vector<uint64_t> limited = server_->get_rate_limited_counts();
+    if (!limited.empty()) {
+        write_header(out, "simple_utcd_rate_limited_total", "counter", "Requests dropped by the rate limiter per limiter shard");
+        for (size_t i = 0; i < limited.size(); ++i) {
+            out << "simple_utcd_rate_limited_total{shard=\"" << i << "\"} " << limited[i] << "\n";
+        }
+    }
+
+    write_header(out, "simple_utcd_errors_total", "counter", "Errors reported through the error handler by severity");
+    for (const auto& entry : ErrorHandlerManager::get_handler().get_error_stats()) {
+        out << "simple_utcd_errors_total{severity=\"" << severity_name(entry.first) << "\"} " << entry.second << "\n";
+    }
+
+    if (logger_) {
+        write_header(out, "simple_utcd_log_records_dropped_total", "counter", "Log records dropped by the async logger");
+        out << "simple_utcd_log_records_dropped_total " << logger_->get_dropped_records() << "\n";
+    }
+
+    if (config_->is_detailed_stats_enabled()) {
+        write_header(out, "simple_utcd_latency_seconds", "summary", "TCP serving latency per worker and merged");
+        for (size_t m = 0; m < static_cast<size_t>(LatencyMetric::COUNT); ++m) {
+            LatencyMetric metric = static_cast<LatencyMetric>(m);
+            std::string metric_label = std::string("metric=\"") + metric_name(metric) + "\"";
+
+            std::vector<LatencySummary> workers = server_->get_worker_latency(metric);
+            for (size_t w = 0; w < workers.size(); ++w) {
+                write_summary(out, metric_label + ",worker=\"" + std::to_string(w) + "\"", workers[w]);
+            }
+            write_summary(out, metric_label, server_->get_latency(metric));
+        }
+
+        write_header(out, "simple_utcd_latency_max_seconds", "gauge", "Largest TCP serving latency observed");
+        for (size_t m = 0; m < static_cast<size_t>(LatencyMetric::COUNT); ++m) {
+            LatencyMetric metric = static_cast<LatencyMetric>(m);
+            out << "simple_utcd_latency_max_seconds{metric=\"" << metric_name(metric) << "\"} "
+                << server_->get_latency(metric).max / 1e9 << "\n";
+        }
+    }
+
+    return out.str();
+}
+
+} // namespace simple_utcd
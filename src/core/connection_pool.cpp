@@ -0,0 +1,105 @@
+/*
+ * src/core/connection_pool.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simple_utcd/connection_pool.hpp"
+#include <new>
+
+namespace simple_utcd {
+
+void ConnectionDeleter::operator()(UTCConnection* connection) const {
+    if (pool) {
+        pool->release(connection);
+    } else {
+        delete connection;
+    }
+}
+
+ConnectionPool::ConnectionPool(size_t capacity, bool thread_safe)
+    : capacity_(capacity > 0 ? capacity : 1)
+    , thread_safe_(thread_safe)
+    , slots_(new Slot[capacity_])
+    , free_list_(nullptr)
+    , in_use_(0)
+    , heap_fallbacks_(0)
+{
+    // Thread the free list back to front so the first acquire gets slot 0
+    for (size_t i = capacity_; i > 0; --i) {
+        slots_[i - 1].next_free = free_list_;
+        free_list_ = &slots_[i - 1];
+    }
+}
+
+ConnectionPtr ConnectionPool::acquire(int socket_fd, const struct sockaddr_storage& peer,
+                                      UTCConfig* config, Logger* logger) {
+    Slot* slot = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(mutex_, std::defer_lock);
+        if (thread_safe_) {
+            lock.lock();
+        }
+        if (free_list_) {
+            slot = free_list_;
+            free_list_ = slot->next_free;
+            in_use_++;
+        } else {
+            heap_fallbacks_++;
+        }
+    }
+
+    if (!slot) {
+        return ConnectionPtr(new UTCConnection(socket_fd, peer, config, logger), ConnectionDeleter{this});
+    }
+
+    auto* connection = new (slot->storage) UTCConnection(socket_fd, peer, config, logger);
+    return ConnectionPtr(connection, ConnectionDeleter{this});
+}
+
+void ConnectionPool::release(UTCConnection* connection) {
+    if (!connection) {
+        return;
+    }
+    if (!owns(connection)) {
+        delete connection;
+        return;
+    }
+
+    connection->~UTCConnection();
+    Slot* slot = reinterpret_cast<Slot*>(connection);
+
+    std::unique_lock<std::mutex> lock(mutex_, std::defer_lock);
+    if (thread_safe_) {
+        lock.lock();
+    }
+    slot->next_free = free_list_;
+    free_list_ = slot;
+    in_use_--;
+}
+
+ConnectionPtr ConnectionPool::make_unpooled(int socket_fd, const struct sockaddr_storage& peer,
+                                            UTCConfig* config, Logger* logger) {
+    return ConnectionPtr(new UTCConnection(socket_fd, peer, config, logger));
+}
+
+bool ConnectionPool::owns(const UTCConnection* connection) const {
+    auto address = reinterpret_cast<uintptr_t>(connection);
+    auto begin = reinterpret_cast<uintptr_t>(slots_.get());
+    auto end = reinterpret_cast<uintptr_t>(slots_.get() + capacity_);
+    return address >= begin && address < end;
+}
+
+} // namespace simple_utcd
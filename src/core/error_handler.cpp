@@ -49,14 +49,14 @@ ErrorContext::ErrorContext(const std::string& comp, const std::string& func,
 DefaultErrorHandler::DefaultErrorHandler(bool enable_logging, ErrorSeverity min_log_level)
     : logging_enabled_(enable_logging)
     , min_log_level_(min_log_level)
-    , error_counts_(4, 0) // Initialize for 4 severity levels
 {
+    reset_stats();
 }
 
 void DefaultErrorHandler::handle_error(const ErrorContext& context, const std::exception* exception) {
     // Update error statistics
     if (static_cast<int>(context.severity) < static_cast<int>(ErrorSeverity::CRITICAL) + 1) {
-        error_counts_[static_cast<int>(context.severity)]++;
+        error_counts_[static_cast<int>(context.severity)].fetch_add(1, std::memory_order_relaxed);
     }
 
     // Log error if enabled and meets minimum level
@@ -80,16 +80,18 @@ std::vector<std::pair<ErrorSeverity, size_t>> DefaultErrorHandler::get_error_sta
     std::vector<std::pair<ErrorSeverity, size_t>> stats;
     stats.reserve(4);
 
-    stats.emplace_back(ErrorSeverity::INFO, error_counts_[0]);
-    stats.emplace_back(ErrorSeverity::WARNING, error_counts_[1]);
-    stats.emplace_back(ErrorSeverity::ERROR, error_counts_[2]);
-    stats.emplace_back(ErrorSeverity::CRITICAL, error_counts_[3]);
+    stats.emplace_back(ErrorSeverity::INFO, error_counts_[0].load(std::memory_order_relaxed));
+    stats.emplace_back(ErrorSeverity::WARNING, error_counts_[1].load(std::memory_order_relaxed));
+    stats.emplace_back(ErrorSeverity::ERROR, error_counts_[2].load(std::memory_order_relaxed));
+    stats.emplace_back(ErrorSeverity::CRITICAL, error_counts_[3].load(std::memory_order_relaxed));
 
     return stats;
 }
 
 void DefaultErrorHandler::reset_stats() {
-    std::fill(error_counts_.begin(), error_counts_.end(), 0);
+    for (auto& count : error_counts_) {
+        count.store(0, std::memory_order_relaxed);
+    }
 }
 
 void DefaultErrorHandler::set_min_log_level(ErrorSeverity level) {
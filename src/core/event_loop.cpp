@@ -0,0 +1,223 @@
+/*
+ * src/core/event_loop.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simple_utcd/event_loop.hpp"
+#include "simple_utcd/error_handler.hpp"
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+namespace simple_utcd {
+
+#ifdef __linux__
+
+namespace {
+
+uint32_t to_native(uint32_t events) {
+    uint32_t native = EPOLLET;
+    if (events & EventLoop::EVENT_READABLE) {
+        native |= EPOLLIN;
+    }
+    if (events & EventLoop::EVENT_WRITABLE) {
+        native |= EPOLLOUT;
+    }
+    return native;
+}
+
+uint32_t from_native(uint32_t native) {
+    uint32_t events = 0;
+    if (native & EPOLLIN) {
+        events |= EventLoop::EVENT_READABLE;
+    }
+    if (native & EPOLLOUT) {
+        events |= EventLoop::EVENT_WRITABLE;
+    }
+    if (native & EPOLLERR) {
+        events |= EventLoop::EVENT_ERROR;
+    }
+    if (native & (EPOLLHUP | EPOLLRDHUP)) {
+        events |= EventLoop::EVENT_HANGUP;
+    }
+    return events;
+}
+
+} // namespace
+
+EventLoop::EventLoop(int max_events)
+    : epoll_fd_(-1)
+    , wakeup_fd_(-1)
+    , max_events_(max_events > 0 ? max_events : 1)
+{
+    events_.resize(sizeof(epoll_event) * max_events_);
+
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        UTC_ERROR("EventLoop", "epoll_create1() failed: " + std::string(strerror(errno)));
+        return;
+    }
+
+    wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeup_fd_ < 0) {
+        UTC_ERROR("EventLoop", "eventfd() failed: " + std::string(strerror(errno)));
+        close(epoll_fd_);
+        epoll_fd_ = -1;
+        return;
+    }
+
+    // The wakeup descriptor is tagged with a null pointer so wait() can filter it
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.ptr = nullptr;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_fd_, &ev) != 0) {
+        UTC_ERROR("EventLoop", "Failed to register wakeup descriptor: " + std::string(strerror(errno)));
+        close(wakeup_fd_);
+        close(epoll_fd_);
+        wakeup_fd_ = -1;
+        epoll_fd_ = -1;
+    }
+}
+
+EventLoop::~EventLoop() {
+    if (wakeup_fd_ >= 0) {
+        close(wakeup_fd_);
+    }
+    if (epoll_fd_ >= 0) {
+        close(epoll_fd_);
+    }
+}
+
+bool EventLoop::is_supported() {
+    return true;
+}
+
+bool EventLoop::add(int fd, uint32_t events, void* data, bool exclusive) {
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = to_native(events);
+    if (exclusive) {
+        ev.events |= EPOLLEXCLUSIVE;
+    }
+    ev.data.ptr = data;
+    return epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) == 0;
+}
+
+bool EventLoop::modify(int fd, uint32_t events, void* data) {
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = to_native(events);
+    ev.data.ptr = data;
+    return epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev) == 0;
+}
+
+bool EventLoop::remove(int fd) {
+    return epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr) == 0;
+}
+
+int EventLoop::wait(int timeout_ms) {
+    epoll_event* events = reinterpret_cast<epoll_event*>(events_.data());
+    int count = epoll_wait(epoll_fd_, events, max_events_, timeout_ms);
+    if (count < 0) {
+        return errno == EINTR ? 0 : -1;
+    }
+
+    // Drop the wakeup notification in place so callers only see their own sources
+    int kept = 0;
+    for (int i = 0; i < count; ++i) {
+        if (events[i].data.ptr == nullptr) {
+            uint64_t value;
+            while (read(wakeup_fd_, &value, sizeof(value)) > 0) {
+            }
+            continue;
+        }
+        events[kept++] = events[i];
+    }
+
+    return kept;
+}
+
+void* EventLoop::event_data(int index) const {
+    const epoll_event* events = reinterpret_cast<const epoll_event*>(events_.data());
+    return events[index].data.ptr;
+}
+
+uint32_t EventLoop::event_flags(int index) const {
+    const epoll_event* events = reinterpret_cast<const epoll_event*>(events_.data());
+    return from_native(events[index].events);
+}
+
+void EventLoop::wakeup() {
+    if (wakeup_fd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t written = write(wakeup_fd_, &one, sizeof(one));
+        (void)written;
+    }
+}
+
+#else
+
+EventLoop::EventLoop(int max_events)
+    : epoll_fd_(-1)
+    , wakeup_fd_(-1)
+    , max_events_(max_events)
+{
+}
+
+EventLoop::~EventLoop() {
+}
+
+bool EventLoop::is_supported() {
+    return false;
+}
+
+bool EventLoop::add(int, uint32_t, void*, bool) {
+    return false;
+}
+
+bool EventLoop::modify(int, uint32_t, void*) {
+    return false;
+}
+
+bool EventLoop::remove(int) {
+    return false;
+}
+
+int EventLoop::wait(int) {
+    return -1;
+}
+
+void* EventLoop::event_data(int) const {
+    return nullptr;
+}
+
+uint32_t EventLoop::event_flags(int) const {
+    return 0;
+}
+
+void EventLoop::wakeup() {
+}
+
+#endif
+
+} // namespace simple_utcd
@@ -0,0 +1,117 @@
+/*
+ * src/core/latency_histogram.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simple_utcd/latency_histogram.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace simple_utcd {
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+void LatencyHistogram::merge_from(const LatencyHistogram& other) {
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        uint64_t value = other.counts_[i].load(std::memory_order_relaxed);
+        if (value) {
+            counts_[i].store(counts_[i].load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+    }
+    sum_.store(sum() + other.sum(), std::memory_order_relaxed);
+    if (other.max() > max()) {
+        max_.store(other.max(), std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::reset() {
+    for (auto& count : counts_) {
+        count.store(0, std::memory_order_relaxed);
+    }
+    max_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::count() const {
+    uint64_t total = 0;
+    for (const auto& count : counts_) {
+        total += count.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t LatencyHistogram::percentile(double q) const {
+    uint64_t total = count();
+    if (total == 0) {
+        return 0;
+    }
+
+    uint64_t rank = static_cast<uint64_t>(std::ceil(std::min(1.0, std::max(0.0, q)) * total));
+    rank = std::max<uint64_t>(1, rank);
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        seen += counts_[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            // The bucket bound can overshoot the largest value actually seen
+            return std::min(bucket_upper_bound(i), max());
+        }
+    }
+    return max();
+}
+
+LatencySummary LatencyHistogram::summary() const {
+    LatencySummary summary;
+    summary.count = count();
+    summary.p50 = percentile(0.50);
+    summary.p99 = percentile(0.99);
+    summary.p999 = percentile(0.999);
+    summary.max = max();
+    summary.sum = sum();
+    return summary;
+}
+
+size_t LatencyHistogram::bucket_index(uint64_t value) {
+    if (value < SUB_BUCKETS) {
+        return static_cast<size_t>(value);
+    }
+
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - SUB_BUCKET_BITS;
+    size_t sub = static_cast<size_t>(value >> shift) & (SUB_BUCKETS - 1);
+    size_t index = static_cast<size_t>(shift + 1) * SUB_BUCKETS + sub;
+    return std::min(index, BUCKETS - 1);
+}
+
+uint64_t LatencyHistogram::bucket_upper_bound(size_t index) {
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+
+    int shift = static_cast<int>(index / SUB_BUCKETS) - 1;
+    uint64_t lower = (SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+    return lower + (uint64_t(1) << shift) - 1;
+}
+
+uint64_t LatencyHistogram::now_ns() {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+}
+
+} // namespace simple_utcd
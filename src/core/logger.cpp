@@ -23,15 +23,65 @@
 #include <iomanip>
 #include <chrono>
 #include <ctime>
+#include <cstring>
+#include <algorithm>
 #include <syslog.h>
 #include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
 
 namespace simple_utcd {
 
+namespace {
+
+const char* level_name(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG: return "DEBUG";
+        case LogLevel::INFO: return "INFO";
+        case LogLevel::WARN: return "WARN";
+        case LogLevel::ERROR: return "ERROR";
+        default: return "UNKNOWN";
+    }
+}
+
+int syslog_priority(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG: return LOG_DEBUG;
+        case LogLevel::INFO: return LOG_INFO;
+        case LogLevel::WARN: return LOG_WARNING;
+        case LogLevel::ERROR: return LOG_ERR;
+        default: return LOG_INFO;
+    }
+}
+
+} // namespace
+
+void append_value(LogBuffer& out, const struct sockaddr_storage& address) {
+    char text[INET6_ADDRSTRLEN];
+    const char* rendered = nullptr;
+
+    if (address.ss_family == AF_INET) {
+        const auto* in = reinterpret_cast<const struct sockaddr_in*>(&address);
+        rendered = inet_ntop(AF_INET, &in->sin_addr, text, sizeof(text));
+    } else if (address.ss_family == AF_INET6) {
+        const auto* in6 = reinterpret_cast<const struct sockaddr_in6*>(&address);
+        rendered = inet_ntop(AF_INET6, &in6->sin6_addr, text, sizeof(text));
+    }
+
+    append_value(out, rendered ? rendered : "unknown");
+}
+
 Logger::Logger()
     : current_level_(LogLevel::INFO)
     , console_enabled_(true)
     , syslog_enabled_(false)
+    , async_(false)
+    , writer_running_(false)
+    , flush_interval_ms_(200)
+    , flush_bytes_(65536)
+    , overflow_policy_(LogOverflowPolicy::DROP)
+    , dropped_records_(0)
 {
     // Initialize syslog if enabled
     if (syslog_enabled_) {
@@ -40,6 +90,8 @@ Logger::Logger()
 }
 
 Logger::~Logger() {
+    disable_async();
+
     if (syslog_enabled_) {
         closelog();
     }
@@ -50,7 +102,7 @@ Logger::~Logger() {
 }
 
 void Logger::set_level(LogLevel level) {
-    current_level_ = level;
+    current_level_.store(level, std::memory_order_relaxed);
 }
 
 void Logger::set_log_file(const std::string& filename) {
@@ -80,6 +132,54 @@ void Logger::enable_syslog(bool enable) {
     }
 }
 
+void Logger::enable_async(size_t queue_size, int flush_interval_ms, size_t flush_bytes,
+                          LogOverflowPolicy policy) {
+    if (async_) {
+        return;
+    }
+
+    flush_interval_ms_ = std::max(1, flush_interval_ms);
+    flush_bytes_ = std::max<size_t>(RECORD_SIZE, flush_bytes);
+    overflow_policy_ = policy;
+    queue_ = std::make_unique<MPMCQueue<LogRecord>>(std::max<size_t>(2, queue_size));
+
+    writer_running_ = true;
+    writer_thread_ = std::thread(&Logger::writer_main, this);
+    async_.store(true, std::memory_order_release);
+}
+
+void Logger::disable_async() {
+    if (!async_) {
+        return;
+    }
+
+    // The queue stays allocated so a late producer never touches freed memory
+    async_ = false;
+    writer_running_ = false;
+    queue_->notify_all();
+    if (writer_thread_.joinable()) {
+        writer_thread_.join();
+    }
+}
+
+LogLevel Logger::parse_level(const std::string& level) {
+    std::string upper = level;
+    std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+
+    if (upper == "DEBUG") {
+        return LogLevel::DEBUG;
+    } else if (upper == "WARN" || upper == "WARNING") {
+        return LogLevel::WARN;
+    } else if (upper == "ERROR") {
+        return LogLevel::ERROR;
+    }
+    return LogLevel::INFO;
+}
+
+LogOverflowPolicy Logger::parse_overflow_policy(const std::string& policy) {
+    return policy == "block" ? LogOverflowPolicy::BLOCK : LogOverflowPolicy::DROP;
+}
+
 void Logger::debug(const std::string& message) {
     log(LogLevel::DEBUG, message);
 }
@@ -97,53 +197,170 @@ void Logger::error(const std::string& message) {
 }
 
 void Logger::log(LogLevel level, const std::string& message) {
-    if (level < current_level_) {
+    if (!should_log(level)) {
         return;
     }
+    write(level, message.data(), message.size());
+}
 
-    std::lock_guard<std::mutex> lock(log_mutex_);
+LogBuffer& Logger::thread_buffer() {
+    thread_local LogBuffer buffer;
+    return buffer;
+}
 
-    std::string timestamp = get_timestamp();
-    std::string level_str = level_to_string(level);
-    std::string log_message = "[" + timestamp + "] [" + level_str + "] " + message;
+void Logger::write(LogLevel level, const char* message, size_t length) {
+    if (async_.load(std::memory_order_acquire)) {
+        enqueue(level, message, length);
+        return;
+    }
+
+    char prefix[64];
+    size_t prefix_length = format_prefix(prefix, sizeof(prefix), level);
+
+    std::lock_guard<std::mutex> lock(log_mutex_);
 
     // Console output
     if (console_enabled_) {
-        if (level >= LogLevel::ERROR) {
-            std::cerr << log_message << std::endl;
-        } else {
-            std::cout << log_message << std::endl;
-        }
+        std::ostream& stream = level >= LogLevel::ERROR ? std::cerr : std::cout;
+        stream.write(prefix, static_cast<std::streamsize>(prefix_length));
+        stream.write(message, static_cast<std::streamsize>(length));
+        stream << std::endl;
     }
 
     // File output
     if (file_stream_ && file_stream_->is_open()) {
-        *file_stream_ << log_message << std::endl;
+        file_stream_->write(prefix, static_cast<std::streamsize>(prefix_length));
+        file_stream_->write(message, static_cast<std::streamsize>(length));
+        *file_stream_ << std::endl;
         file_stream_->flush();
     }
 
     // Syslog output
     if (syslog_enabled_) {
-        int priority;
-        switch (level) {
-            case LogLevel::DEBUG:
-                priority = LOG_DEBUG;
-                break;
-            case LogLevel::INFO:
-                priority = LOG_INFO;
-                break;
-            case LogLevel::WARN:
-                priority = LOG_WARNING;
-                break;
-            case LogLevel::ERROR:
-                priority = LOG_ERR;
-                break;
-            default:
-                priority = LOG_INFO;
-                break;
+        syslog(syslog_priority(level), "%.*s", static_cast<int>(length), message);
+    }
+}
+
+size_t Logger::format_prefix(char* out, size_t size, LogLevel level) {
+    // "[YYYY-MM-DD HH:MM:SS.mmm] [LEVEL] "
+    const char* name = level_name(level);
+    size_t name_length = strlen(name);
+    if (size < 24 + name_length + 6) {
+        return 0;
+    }
+
+    size_t pos = 0;
+    out[pos++] = '[';
+    pos += format_timestamp(out + pos, size - pos);
+    out[pos++] = ']';
+    out[pos++] = ' ';
+    out[pos++] = '[';
+    memcpy(out + pos, name, name_length);
+    pos += name_length;
+    out[pos++] = ']';
+    out[pos++] = ' ';
+    return pos;
+}
+
+void Logger::format_record(LogRecord& record, LogLevel level, const char* message, size_t length) {
+    char* out = record.text;
+    size_t pos = format_prefix(out, RECORD_SIZE, level);
+
+    record.level = level;
+    record.message_offset = static_cast<uint16_t>(pos);
+
+    // Leave room for the terminator; mark truncated lines
+    size_t room = RECORD_SIZE - 1 - pos;
+    if (length <= room) {
+        memcpy(out + pos, message, length);
+        pos += length;
+    } else {
+        memcpy(out + pos, message, room - 3);
+        pos += room - 3;
+        memcpy(out + pos, "...", 3);
+        pos += 3;
+    }
+    out[pos] = '\0';
+    record.length = static_cast<uint16_t>(pos);
+}
+
+void Logger::enqueue(LogLevel level, const char* message, size_t length) {
+    LogRecord record;
+    format_record(record, level, message, length);
+
+    if (queue_->try_push(record)) {
+        return;
+    }
+
+    if (overflow_policy_ == LogOverflowPolicy::DROP) {
+        dropped_records_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    while (!queue_->try_push(record)) {
+        std::this_thread::yield();
+    }
+}
+
+void Logger::writer_main() {
+    using clock = std::chrono::steady_clock;
+    const auto interval = std::chrono::milliseconds(flush_interval_ms_);
+
+    std::string file_batch;
+    std::string out_batch;
+    std::string err_batch;
+    file_batch.reserve(flush_bytes_ + RECORD_SIZE);
+
+    auto flush = [&]() {
+        std::lock_guard<std::mutex> lock(log_mutex_);
+        if (!file_batch.empty() && file_stream_ && file_stream_->is_open()) {
+            file_stream_->write(file_batch.data(), static_cast<std::streamsize>(file_batch.size()));
+            file_stream_->flush();
+        }
+        if (!out_batch.empty()) {
+            std::cout.write(out_batch.data(), static_cast<std::streamsize>(out_batch.size()));
+            std::cout.flush();
+        }
+        if (!err_batch.empty()) {
+            std::cerr.write(err_batch.data(), static_cast<std::streamsize>(err_batch.size()));
+            std::cerr.flush();
+        }
+        file_batch.clear();
+        out_batch.clear();
+        err_batch.clear();
+    };
+
+    LogRecord record;
+    auto next_flush = clock::now() + interval;
+
+    for (;;) {
+        auto now = clock::now();
+        auto wait = next_flush > now ? next_flush - now : clock::duration::zero();
+
+        if (queue_->pop_wait(record, wait)) {
+            // Discarded at flush time if no log file is open
+            file_batch.append(record.text, record.length);
+            file_batch.push_back('\n');
+            if (console_enabled_) {
+                std::string& console = record.level >= LogLevel::ERROR ? err_batch : out_batch;
+                console.append(record.text, record.length);
+                console.push_back('\n');
+            }
+            if (syslog_enabled_) {
+                syslog(syslog_priority(record.level), "%s", record.text + record.message_offset);
+            }
+        } else if (!writer_running_) {
+            break;  // stopping and the ring is drained
+        }
+
+        size_t pending = file_batch.size() + out_batch.size() + err_batch.size();
+        if (pending >= flush_bytes_ || clock::now() >= next_flush) {
+            flush();
+            next_flush = clock::now() + interval;
         }
-        syslog(priority, "%s", message.c_str());
     }
+
+    flush();
 }
 
 std::string Logger::level_to_string(LogLevel level) {
@@ -162,16 +379,40 @@ std::string Logger::level_to_string(LogLevel level) {
 }
 
 std::string Logger::get_timestamp() {
+    char buffer[32];
+    size_t length = format_timestamp(buffer, sizeof(buffer));
+    return std::string(buffer, length);
+}
+
+size_t Logger::format_timestamp(char* out, size_t size) {
+    // The date/time part only changes once a second; cache it per thread
+    thread_local std::time_t cached_second = -1;
+    thread_local char cached_text[20];
+
     auto now = std::chrono::system_clock::now();
     auto time_t = std::chrono::system_clock::to_time_t(now);
     auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()) % 1000;
+        now.time_since_epoch()).count() % 1000;
 
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
-    ss << '.' << std::setfill('0') << std::setw(3) << ms.count();
+    if (time_t != cached_second) {
+        std::tm tm;
+        localtime_r(&time_t, &tm);
+        strftime(cached_text, sizeof(cached_text), "%Y-%m-%d %H:%M:%S", &tm);
+        cached_second = time_t;
+    }
 
-    return ss.str();
+    // "YYYY-MM-DD HH:MM:SS.mmm"
+    const size_t length = 23;
+    if (size < length + 1) {
+        return 0;
+    }
+    memcpy(out, cached_text, 19);
+    out[19] = '.';
+    out[20] = static_cast<char>('0' + ms / 100);
+    out[21] = static_cast<char>('0' + (ms / 10) % 10);
+    out[22] = static_cast<char>('0' + ms % 10);
+    out[23] = '\0';
+    return length;
 }
 
 } // namespace simple_utcd
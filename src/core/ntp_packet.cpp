@@ -0,0 +1,63 @@
+/*
+ * src/core/ntp_packet.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simple_utcd/ntp_packet.hpp"
+
+namespace simple_utcd {
+
+namespace {
+
+constexpr int64_t NS_PER_SECOND = 1000000000;
+
+} // namespace
+
+int64_t NTPPacket::era_seconds_to_unix(uint32_t seconds) {
+    int64_t full = seconds;
+    if (seconds < 0x80000000u) {
+        full += int64_t(1) << 32;
+    }
+    return full - EPOCH_DELTA;
+}
+
+uint64_t NTPPacket::to_timestamp(int64_t unix_ns) {
+    uint64_t seconds = static_cast<uint64_t>(unix_ns / NS_PER_SECOND + EPOCH_DELTA) & 0xFFFFFFFFu;
+    uint64_t fraction = (static_cast<uint64_t>(unix_ns % NS_PER_SECOND) << 32) / NS_PER_SECOND;
+    return (seconds << 32) | fraction;
+}
+
+int64_t NTPPacket::from_timestamp(uint64_t timestamp) {
+    int64_t seconds = era_seconds_to_unix(static_cast<uint32_t>(timestamp >> 32));
+    int64_t fraction = static_cast<int64_t>(((timestamp & 0xFFFFFFFFu) * NS_PER_SECOND) >> 32);
+    return seconds * NS_PER_SECOND + fraction;
+}
+
+uint32_t NTPPacket::to_short(int64_t nanoseconds) {
+    if (nanoseconds <= 0) {
+        return 0;
+    }
+    if (nanoseconds >= 65536 * NS_PER_SECOND) {
+        return 0xFFFFFFFFu;
+    }
+    return static_cast<uint32_t>((static_cast<uint64_t>(nanoseconds) << 16) / NS_PER_SECOND);
+}
+
+int64_t NTPPacket::from_short(uint32_t value) {
+    return static_cast<int64_t>((static_cast<uint64_t>(value) * NS_PER_SECOND) >> 16);
+}
+
+} // namespace simple_utcd
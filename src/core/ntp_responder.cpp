@@ -0,0 +1,124 @@
+/*
+ * src/core/ntp_responder.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simple_utcd/ntp_responder.hpp"
+#include "simple_utcd/utc_config.hpp"
+#include "simple_utcd/utc_packet.hpp"
+#include "simple_utcd/time_synchronizer.hpp"
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#endif
+
+namespace simple_utcd {
+
+namespace {
+
+constexpr uint8_t STRATUM_UNSYNCHRONIZED = 16;
+
+// Poll exponents RFC 5905 allows a server to echo
+constexpr uint8_t MIN_POLL = 4;
+constexpr uint8_t MAX_POLL = 17;
+
+// Four ASCII characters, or the IPv4 address of an upstream for stratum 2 and up
+std::array<uint8_t, 4> make_reference_id(const std::string& text, bool allow_address) {
+    std::array<uint8_t, 4> id{};
+    struct in_addr address;
+    if (allow_address && inet_pton(AF_INET, text.c_str(), &address) == 1) {
+        memcpy(id.data(), &address, id.size());
+        return id;
+    }
+    memcpy(id.data(), text.data(), std::min(text.size(), id.size()));
+    return id;
+}
+
+} // namespace
+
+NTPResponder::NTPResponder(const UTCConfig* config, const TimeSynchronizer* synchronizer)
+    : synchronizer_(synchronizer)
+    , stratum_(static_cast<uint8_t>(std::min(15, std::max(1, config->get_stratum()))))
+{
+    // A primary server names its clock; a secondary one names its source
+    reference_id_ = stratum_ == 1 ? make_reference_id(config->get_reference_clock(), false)
+                                  : make_reference_id(config->get_reference_id(), true);
+}
+
+NTPResponder::Header NTPResponder::header(int64_t now_ns) const {
+    Header header{};
+
+    uint8_t leap = NTPPacket::LEAP_NONE;
+    uint8_t stratum = stratum_;
+    int64_t root_delay = 0;
+    int64_t root_dispersion = 0;
+    int64_t reference_ns = now_ns - now_ns % 1000000000;
+
+    if (synchronizer_) {
+        if (synchronizer_->is_synchronized()) {
+            root_delay = synchronizer_->get_root_delay_ns();
+            root_dispersion = synchronizer_->get_root_dispersion_ns();
+            reference_ns = synchronizer_->get_reference_time_ns();
+        } else {
+            // Clients must not take time from us before the first upstream answer
+            leap = NTPPacket::LEAP_ALARM;
+            stratum = STRATUM_UNSYNCHRONIZED;
+            reference_ns = 0;
+        }
+    }
+
+    header[NTPPacket::OFFSET_FLAGS] = NTPPacket::make_flags(leap, 4, NTPPacket::MODE_SERVER);
+    header[NTPPacket::OFFSET_STRATUM] = stratum;
+    header[NTPPacket::OFFSET_PRECISION] = static_cast<uint8_t>(PRECISION);
+    UTCPacket::store_be32(NTPPacket::to_short(root_delay), &header[NTPPacket::OFFSET_ROOT_DELAY]);
+    UTCPacket::store_be32(NTPPacket::to_short(root_dispersion), &header[NTPPacket::OFFSET_ROOT_DISPERSION]);
+    memcpy(&header[NTPPacket::OFFSET_REFERENCE_ID], reference_id_.data(), reference_id_.size());
+    NTPPacket::store_be64(reference_ns ? NTPPacket::to_timestamp(reference_ns) : 0,
+                          &header[NTPPacket::OFFSET_REFERENCE_TIME]);
+    return header;
+}
+
+bool NTPResponder::respond(const Header& header, uint8_t* packet, size_t size, int64_t receive_ns) const {
+    if (size < NTPPacket::PACKET_SIZE) {
+        return false;
+    }
+
+    // Only client requests; control (6) and private (7) modes would make us an amplifier
+    uint8_t flags = packet[NTPPacket::OFFSET_FLAGS];
+    uint8_t version = NTPPacket::version(flags);
+    if (NTPPacket::mode(flags) != NTPPacket::MODE_CLIENT || version < 1 || version > 4) {
+        return false;
+    }
+
+    uint8_t poll = std::min(MAX_POLL, std::max(MIN_POLL, packet[NTPPacket::OFFSET_POLL]));
+
+    // The client's transmit time comes back as our origin time, byte for byte
+    memcpy(packet + NTPPacket::OFFSET_ORIGIN_TIME, packet + NTPPacket::OFFSET_TRANSMIT_TIME, 8);
+    memcpy(packet, header.data(), header.size());
+
+    packet[NTPPacket::OFFSET_FLAGS] = NTPPacket::make_flags(NTPPacket::leap(header[NTPPacket::OFFSET_FLAGS]),
+                                                           version, NTPPacket::MODE_SERVER);
+    packet[NTPPacket::OFFSET_POLL] = poll;
+    NTPPacket::store_be64(NTPPacket::to_timestamp(receive_ns), packet + NTPPacket::OFFSET_RECEIVE_TIME);
+    return true;
+}
+
+} // namespace simple_utcd
@@ -31,6 +31,7 @@
 #include <fcntl.h>
 #include <sys/types.h>
 #include <cstdlib>
+#include <cerrno>
 
 #ifdef _WIN32
 #include <winsock2.h>
@@ -44,11 +45,15 @@
 #elif __linux__
 #include <sys/time.h>
 #include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
 #endif
 
 namespace simple_utcd {
 
-std::string Platform::last_error_;
+thread_local std::string Platform::last_error_;
 
 bool Platform::is_windows() {
 #ifdef _WIN32
@@ -140,22 +145,41 @@ bool Platform::set_socket_option(int socket_fd, int level, int option, const voi
     return true;
 }
 
-bool Platform::bind_socket(int socket_fd, const std::string& address, int port) {
-    struct sockaddr_in addr;
+bool Platform::resolve_address(const std::string& address, int port, bool allow_ipv6,
+                               struct sockaddr_storage& addr, size_t& length) {
     memset(&addr, 0, sizeof(addr));
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(port);
+    bool wildcard = address.empty() || address == "0.0.0.0" || address == "::";
+
+    auto* in = reinterpret_cast<struct sockaddr_in*>(&addr);
+    if ((wildcard && !allow_ipv6) || (!wildcard && inet_pton(AF_INET, address.c_str(), &in->sin_addr) == 1)) {
+        in->sin_family = AF_INET;
+        in->sin_port = htons(static_cast<uint16_t>(port));
+        if (wildcard) {
+            in->sin_addr.s_addr = htonl(INADDR_ANY);
+        }
+        length = sizeof(struct sockaddr_in);
+        return true;
+    }
 
-    if (address.empty() || address == "0.0.0.0") {
-        addr.sin_addr.s_addr = INADDR_ANY;
-    } else {
-        if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) <= 0) {
-            last_error_ = "Invalid address: " + address;
-            return false;
+    auto* in6 = reinterpret_cast<struct sockaddr_in6*>(&addr);
+    if (allow_ipv6 && (wildcard || inet_pton(AF_INET6, address.c_str(), &in6->sin6_addr) == 1)) {
+        in6->sin6_family = AF_INET6;
+        in6->sin6_port = htons(static_cast<uint16_t>(port));
+        if (wildcard) {
+            in6->sin6_addr = in6addr_any;
         }
+        length = sizeof(struct sockaddr_in6);
+        return true;
     }
 
-    int result = bind(socket_fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+    last_error_ = allow_ipv6 || inet_pton(AF_INET6, address.c_str(), &in6->sin6_addr) != 1
+        ? "Invalid address: " + address
+        : "IPv6 address " + address + " requires enable_ipv6";
+    return false;
+}
+
+bool Platform::bind_socket(int socket_fd, const struct sockaddr_storage& addr, size_t length) {
+    int result = bind(socket_fd, reinterpret_cast<const struct sockaddr*>(&addr), static_cast<socklen_t>(length));
     if (result != 0) {
 #ifdef _WIN32
         last_error_ = "bind() failed: " + std::to_string(WSAGetLastError());
@@ -167,6 +191,12 @@ bool Platform::bind_socket(int socket_fd, const std::string& address, int port)
     return true;
 }
 
+bool Platform::set_dual_stack(int socket_fd) {
+    // Explicit, since the default follows net.ipv6.bindv6only (and is on for Windows)
+    int v6_only = 0;
+    return set_socket_option(socket_fd, IPPROTO_IPV6, IPV6_V6ONLY, &v6_only, sizeof(v6_only));
+}
+
 bool Platform::listen_socket(int socket_fd, int backlog) {
     int result = listen(socket_fd, backlog);
     if (result != 0) {
@@ -180,11 +210,10 @@ bool Platform::listen_socket(int socket_fd, int backlog) {
     return true;
 }
 
-int Platform::accept_connection(int socket_fd, std::string& client_address) {
-    struct sockaddr_in client_addr;
-    socklen_t client_len = sizeof(client_addr);
+int Platform::accept_connection(int socket_fd, struct sockaddr_storage* client_addr) {
+    socklen_t client_len = sizeof(*client_addr);
 
-    int client_fd = accept(socket_fd, reinterpret_cast<struct sockaddr*>(&client_addr), &client_len);
+    int client_fd = accept(socket_fd, reinterpret_cast<struct sockaddr*>(client_addr), &client_len);
     if (client_fd < 0) {
 #ifdef _WIN32
         last_error_ = "accept() failed: " + std::to_string(WSAGetLastError());
@@ -194,13 +223,192 @@ int Platform::accept_connection(int socket_fd, std::string& client_address) {
         return -1;
     }
 
-    char client_ip[INET_ADDRSTRLEN];
-    inet_ntop(AF_INET, &client_addr.sin_addr, client_ip, INET_ADDRSTRLEN);
-    client_address = std::string(client_ip);
+    return client_fd;
+}
+
+int Platform::accept_nonblocking(int socket_fd, struct sockaddr_storage* client_addr) {
+    socklen_t client_len = sizeof(*client_addr);
 
+#ifdef __linux__
+    int client_fd = accept4(socket_fd, reinterpret_cast<struct sockaddr*>(client_addr), &client_len,
+                            SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+    int client_fd = accept(socket_fd, reinterpret_cast<struct sockaddr*>(client_addr), &client_len);
+    if (client_fd >= 0 && !set_nonblocking(client_fd)) {
+        close_socket(client_fd);
+        return -1;
+    }
+#endif
+
+    if (client_fd < 0 && !would_block()) {
+#ifdef _WIN32
+        last_error_ = "accept() failed: " + std::to_string(WSAGetLastError());
+#else
+        last_error_ = "accept() failed: " + std::string(strerror(errno));
+#endif
+    }
     return client_fd;
 }
 
+bool Platform::enable_timestamping(int socket_fd, bool receive, bool transmit) {
+#ifdef __linux__
+    unsigned int flags = SOF_TIMESTAMPING_SOFTWARE;
+    if (receive) {
+        flags |= SOF_TIMESTAMPING_RX_SOFTWARE;
+    }
+    if (transmit) {
+        flags |= SOF_TIMESTAMPING_TX_SOFTWARE;
+    }
+    if (setsockopt(socket_fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) == 0) {
+        return true;
+    }
+    if (transmit) {
+        last_error_ = "SO_TIMESTAMPING failed: " + std::string(strerror(errno));
+        return false;
+    }
+#else
+    if (transmit) {
+        last_error_ = "Transmit timestamps not supported on this platform";
+        return false;
+    }
+#endif
+
+#ifdef SO_TIMESTAMPNS
+    int enable = receive ? 1 : 0;
+    return set_socket_option(socket_fd, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable));
+#else
+    (void)socket_fd;
+    if (receive) {
+        last_error_ = "Receive timestamps not supported on this platform";
+        return false;
+    }
+    return true;
+#endif
+}
+
+int64_t Platform::receive_timestamp_ns(const struct msghdr& message) {
+#ifdef __linux__
+    struct msghdr* hdr = const_cast<struct msghdr*>(&message);
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(hdr); cmsg; cmsg = CMSG_NXTHDR(hdr, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET) {
+            continue;
+        }
+        struct timespec stamp;
+        if (cmsg->cmsg_type == SCM_TIMESTAMPING) {
+            // Software stamp in the first slot; the others are hardware
+            memcpy(&stamp, CMSG_DATA(cmsg), sizeof(stamp));
+        } else if (cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+            memcpy(&stamp, CMSG_DATA(cmsg), sizeof(stamp));
+        } else {
+            continue;
+        }
+        if (stamp.tv_sec != 0 || stamp.tv_nsec != 0) {
+            return static_cast<int64_t>(stamp.tv_sec) * 1000000000 + stamp.tv_nsec;
+        }
+    }
+#else
+    (void)message;
+#endif
+    return 0;
+}
+
+size_t Platform::read_transmit_timestamps(int socket_fd, uint8_t* buffer, size_t size,
+                                          const std::function<void(const uint8_t*, size_t, int64_t)>& callback) {
+    size_t count = 0;
+#ifdef __linux__
+    alignas(struct cmsghdr) char control[256];
+
+    for (;;) {
+        struct iovec iov;
+        iov.iov_base = buffer;
+        iov.iov_len = size;
+
+        struct msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_iov = &iov;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        auto received = recvmsg(socket_fd, &message, MSG_ERRQUEUE | MSG_DONTWAIT);
+        if (received < 0) {
+            break;  // queue drained
+        }
+
+        int64_t sent_ns = 0;
+        bool transmitted = false;
+        for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPING) {
+                struct timespec stamp;
+                memcpy(&stamp, CMSG_DATA(cmsg), sizeof(stamp));
+                sent_ns = static_cast<int64_t>(stamp.tv_sec) * 1000000000 + stamp.tv_nsec;
+            } else if ((cmsg->cmsg_level == IPPROTO_IP && cmsg->cmsg_type == IP_RECVERR) ||
+                       (cmsg->cmsg_level == IPPROTO_IPV6 && cmsg->cmsg_type == IPV6_RECVERR)) {
+                struct sock_extended_err error;
+                memcpy(&error, CMSG_DATA(cmsg), sizeof(error));
+                transmitted = error.ee_origin == SO_EE_ORIGIN_TIMESTAMPING && error.ee_info == SCM_TSTAMP_SND;
+            }
+        }
+
+        // ICMP errors share the queue; only complete software send stamps are reported
+        if (transmitted && sent_ns != 0 && !(message.msg_flags & MSG_TRUNC)) {
+            callback(buffer, static_cast<size_t>(received), sent_ns);
+            count++;
+        }
+    }
+#else
+    (void)socket_fd;
+    (void)buffer;
+    (void)size;
+    (void)callback;
+#endif
+    return count;
+}
+
+bool Platform::set_nonblocking(int socket_fd) {
+#ifdef _WIN32
+    u_long mode = 1;
+    if (ioctlsocket(socket_fd, FIONBIO, &mode) != 0) {
+        last_error_ = "ioctlsocket() failed: " + std::to_string(WSAGetLastError());
+        return false;
+    }
+    return true;
+#else
+    int flags = fcntl(socket_fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(socket_fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        last_error_ = "fcntl() failed: " + std::string(strerror(errno));
+        return false;
+    }
+    return true;
+#endif
+}
+
+bool Platform::would_block() {
+#ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+
+std::string Platform::address_to_string(const struct sockaddr_storage& addr) {
+    char buffer[INET6_ADDRSTRLEN];
+
+    if (addr.ss_family == AF_INET) {
+        const auto* in = reinterpret_cast<const struct sockaddr_in*>(&addr);
+        if (inet_ntop(AF_INET, &in->sin_addr, buffer, sizeof(buffer))) {
+            return std::string(buffer);
+        }
+    } else if (addr.ss_family == AF_INET6) {
+        const auto* in6 = reinterpret_cast<const struct sockaddr_in6*>(&addr);
+        if (inet_ntop(AF_INET6, &in6->sin6_addr, buffer, sizeof(buffer))) {
+            return std::string(buffer);
+        }
+    }
+
+    return "unknown";
+}
+
 uint32_t Platform::get_system_time() {
     return static_cast<uint32_t>(std::time(nullptr));
 }
@@ -215,6 +423,41 @@ void Platform::sleep_milliseconds(int milliseconds) {
     std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
 }
 
+bool Platform::read_tcp_socket_stats(TcpSocketStats& stats) {
+#ifdef __linux__
+    // "TCP: inuse 4 orphan 0 tw 12 alloc 6 mem 1", mem in pages
+    std::ifstream file("/proc/net/sockstat");
+    std::string word;
+    while (file >> word) {
+        if (word != "TCP:") {
+            continue;
+        }
+        std::string name;
+        uint64_t value;
+        for (int i = 0; i < 5 && file >> name >> value; ++i) {
+            if (name == "inuse") {
+                stats.in_use = value;
+            } else if (name == "orphan") {
+                stats.orphaned = value;
+            } else if (name == "tw") {
+                stats.time_wait = value;
+            } else if (name == "alloc") {
+                stats.allocated = value;
+            } else if (name == "mem") {
+                stats.memory_bytes = value * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+            }
+        }
+        return true;
+    }
+    last_error_ = "TCP socket statistics not found in /proc/net/sockstat";
+    return false;
+#else
+    (void)stats;
+    last_error_ = "TCP socket statistics not supported on this platform";
+    return false;
+#endif
+}
+
 bool Platform::file_exists(const std::string& path) {
     struct stat buffer;
     return (stat(path.c_str(), &buffer) == 0);
@@ -286,6 +529,24 @@ int Platform::get_process_id() {
 #endif
 }
 
+bool Platform::set_thread_affinity(int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    int result = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (result != 0) {
+        last_error_ = "pthread_setaffinity_np() failed: " + std::string(strerror(result));
+        return false;
+    }
+    return true;
+#else
+    (void)cpu;
+    last_error_ = "Thread affinity not supported on this platform";
+    return false;
+#endif
+}
+
 std::string Platform::get_process_name() {
 #ifdef _WIN32
     char process_name[MAX_PATH];
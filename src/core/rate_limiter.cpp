@@ -0,0 +1,184 @@
+/*
+ * src/core/rate_limiter.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simple_utcd/rate_limiter.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#endif
+
+namespace simple_utcd {
+
+RateLimiter::RateLimiter(size_t table_size, size_t shards, int requests_per_minute, int burst_size)
+    : shard_count_(round_up(std::max<size_t>(1, shards)))
+    , shard_mask_(shard_count_ - 1)
+    , slots_per_shard_(round_up(std::max<size_t>(MAX_PROBE, table_size / shard_count_)))
+    , slot_mask_(slots_per_shard_ - 1)
+    , tokens_per_ns_(std::max(1, requests_per_minute) / 60e9)
+    , burst_(std::max(1, burst_size))
+    , shards_(new Shard[shard_count_])
+{
+    for (size_t i = 0; i < shard_count_; ++i) {
+        shards_[i].slots.reset(new Slot[slots_per_shard_]);
+    }
+}
+
+bool RateLimiter::allow(const struct sockaddr_storage& address) {
+    return allow(address, now_ns());
+}
+
+bool RateLimiter::allow(const struct sockaddr_storage& address, uint64_t now) {
+    uint64_t key[2];
+    if (!make_key(address, key)) {
+        return true;  // not an IP peer, nothing to key on
+    }
+
+    // Empty slots are marked by last_ns == 0
+    if (now == 0) {
+        now = 1;
+    }
+
+    uint64_t h = hash(key);
+    Shard& shard = shards_[(h >> 48) & shard_mask_];
+    size_t home = static_cast<size_t>(h) & slot_mask_;
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    Slot* found = nullptr;
+    Slot* empty = nullptr;
+    Slot* oldest = nullptr;
+    for (size_t i = 0; i < MAX_PROBE; ++i) {
+        Slot& slot = shard.slots[(home + i) & slot_mask_];
+        if (slot.last_ns == 0) {
+            if (!empty) {
+                empty = &slot;
+            }
+            continue;
+        }
+        if (slot.key[0] == key[0] && slot.key[1] == key[1]) {
+            found = &slot;
+            break;
+        }
+        if (!oldest || slot.last_ns < oldest->last_ns) {
+            oldest = &slot;
+        }
+    }
+
+    if (!found) {
+        // New address: start with a full bucket, evicting the stalest neighbour if needed
+        found = empty;
+        if (!found) {
+            found = oldest;
+            shard.evictions.fetch_add(1, std::memory_order_relaxed);
+        }
+        found->key[0] = key[0];
+        found->key[1] = key[1];
+        found->tokens = burst_;
+        found->last_ns = now;
+    } else if (now > found->last_ns) {
+        double refill = static_cast<double>(now - found->last_ns) * tokens_per_ns_;
+        found->tokens = std::min(burst_, found->tokens + refill);
+        found->last_ns = now;
+    }
+
+    if (found->tokens < 1.0) {
+        shard.dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    found->tokens -= 1.0;
+    return true;
+}
+
+uint64_t RateLimiter::now_ns() {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+}
+
+std::vector<uint64_t> RateLimiter::get_shard_drop_counts() const {
+    std::vector<uint64_t> counts;
+    counts.reserve(shard_count_);
+    for (size_t i = 0; i < shard_count_; ++i) {
+        counts.push_back(shards_[i].dropped.load(std::memory_order_relaxed));
+    }
+    return counts;
+}
+
+uint64_t RateLimiter::get_dropped() const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < shard_count_; ++i) {
+        total += shards_[i].dropped.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t RateLimiter::get_evictions() const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < shard_count_; ++i) {
+        total += shards_[i].evictions.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+bool RateLimiter::make_key(const struct sockaddr_storage& address, uint64_t key[2]) {
+    uint8_t bytes[16];
+    if (address.ss_family == AF_INET) {
+        // Same key as the IPv4-mapped IPv6 form, so dual-stack peers share a bucket
+        const auto* in = reinterpret_cast<const struct sockaddr_in*>(&address);
+        memset(bytes, 0, 10);
+        bytes[10] = 0xff;
+        bytes[11] = 0xff;
+        memcpy(bytes + 12, &in->sin_addr, 4);
+    } else if (address.ss_family == AF_INET6) {
+        const auto* in6 = reinterpret_cast<const struct sockaddr_in6*>(&address);
+        memcpy(bytes, &in6->sin6_addr, 16);
+    } else {
+        return false;
+    }
+
+    memcpy(&key[0], bytes, 8);
+    memcpy(&key[1], bytes + 8, 8);
+    return true;
+}
+
+uint64_t RateLimiter::hash(const uint64_t key[2]) {
+    // splitmix64 finaliser over both halves
+    uint64_t x = key[0] ^ (key[1] * 0x9e3779b97f4a7c15ULL);
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+size_t RateLimiter::round_up(size_t value) {
+    size_t size = 1;
+    while (size < value) {
+        size <<= 1;
+    }
+    return size;
+}
+
+} // namespace simple_utcd
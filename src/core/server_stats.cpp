@@ -0,0 +1,70 @@
+/*
+ * src/core/server_stats.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simple_utcd/server_stats.hpp"
+
+namespace simple_utcd {
+
+ServerStats::ServerStats(size_t slots)
+    : slot_count_(slots > 0 ? slots : 1)
+    , slots_(new Slot[slot_count_])
+{
+    for (size_t i = 0; i < slot_count_; ++i) {
+        for (auto& value : slots_[i].values) {
+            value.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+uint64_t ServerStats::get(Counter counter) const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < slot_count_; ++i) {
+        total += slots_[i].values[static_cast<size_t>(counter)].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+StatsSnapshot ServerStats::snapshot() const {
+    uint64_t totals[COUNTERS] = {};
+    for (size_t i = 0; i < slot_count_; ++i) {
+        for (size_t c = 0; c < COUNTERS; ++c) {
+            totals[c] += slots_[i].values[c].load(std::memory_order_relaxed);
+        }
+    }
+
+    StatsSnapshot snapshot;
+    uint64_t accepted = totals[static_cast<size_t>(Counter::CONNECTIONS_ACCEPTED)];
+    uint64_t closed = totals[static_cast<size_t>(Counter::CONNECTIONS_CLOSED)];
+    snapshot.total_connections = accepted;
+    snapshot.active_connections = accepted > closed ? accepted - closed : 0;
+    snapshot.connections_denied = totals[static_cast<size_t>(Counter::CONNECTIONS_DENIED)];
+    snapshot.connections_rejected = totals[static_cast<size_t>(Counter::CONNECTIONS_REJECTED)];
+    snapshot.connections_timed_out = totals[static_cast<size_t>(Counter::CONNECTIONS_TIMED_OUT)];
+    snapshot.packets_sent = totals[static_cast<size_t>(Counter::PACKETS_SENT)];
+    snapshot.packets_received = totals[static_cast<size_t>(Counter::PACKETS_RECEIVED)];
+    snapshot.accept_failures = totals[static_cast<size_t>(Counter::ACCEPT_FAILED)];
+    return snapshot;
+}
+
+size_t ServerStats::thread_index() {
+    static std::atomic<size_t> next_index{0};
+    thread_local size_t index = next_index.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+} // namespace simple_utcd
@@ -0,0 +1,185 @@
+/*
+ * src/core/shm_publisher.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simple_utcd/shm_publisher.hpp"
+#include "simple_utcd/time_source.hpp"
+#include "simple_utcd/time_synchronizer.hpp"
+#include "simple_utcd/ntp_packet.hpp"
+#include "simple_utcd/error_handler.hpp"
+#include "simple_utcd/logger.hpp"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace simple_utcd {
+
+namespace {
+
+constexpr int64_t NS_PER_SECOND = 1000000000;
+
+} // namespace
+
+ShmPublisher::ShmPublisher(const std::string& name, const TimeSynchronizer* synchronizer, Logger* logger)
+    : name_(name)
+    , synchronizer_(synchronizer)
+    , logger_(logger)
+    , segment_(nullptr)
+    , running_(false)
+{
+}
+
+ShmPublisher::~ShmPublisher() {
+    stop();
+}
+
+bool ShmPublisher::start() {
+#ifdef _WIN32
+    UTC_ERROR("ShmPublisher", "Shared-memory time publication is not supported on this platform");
+    return false;
+#else
+    if (segment_) {
+        return false;
+    }
+
+    // Reuse the segment of a previous run so mapped readers keep working
+    int fd = shm_open(name_.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        UTC_ERROR("ShmPublisher", "Failed to open shared memory " + name_ + ": " + strerror(errno));
+        return false;
+    }
+
+    // Anyone else's segment could feed local clients a forged time
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_uid != geteuid()) {
+        UTC_ERROR("ShmPublisher", "Shared memory " + name_ + " exists and belongs to another user");
+        close(fd);
+        return false;
+    }
+    fchmod(fd, 0644);
+
+    void* mapping = MAP_FAILED;
+    if (ftruncate(fd, sizeof(ShmTimeSegment)) == 0) {
+        mapping = mmap(nullptr, sizeof(ShmTimeSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        UTC_ERROR("ShmPublisher", "Failed to map shared memory " + name_ + ": " + strerror(errno));
+        return false;
+    }
+    segment_ = static_cast<ShmTimeSegment*>(mapping);
+
+    // Readers are shut out until the first publish; a fresh or foreign-version segment is laid out anew
+    bool reuse = segment_->magic.load(std::memory_order_relaxed) == SHM_TIME_MAGIC &&
+                 segment_->version == SHM_TIME_VERSION;
+    segment_->magic.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    segment_->version = SHM_TIME_VERSION;
+
+    // A daemon killed inside shm_time_write leaves the sequence odd, which no reader would ever accept
+    uint32_t sequence = reuse ? segment_->sequence.load(std::memory_order_relaxed) : 0;
+    segment_->sequence.store((sequence + 1) & ~1u, std::memory_order_relaxed);
+    segment_->update_interval_ms = UPDATE_INTERVAL_MS;
+    publish();
+    segment_->magic.store(SHM_TIME_MAGIC, std::memory_order_release);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = true;
+    }
+    thread_ = std::thread(&ShmPublisher::thread_main, this);
+
+    if (logger_) {
+        logger_->info("Publishing time in shared memory {} every {}ms", name_, UPDATE_INTERVAL_MS);
+    }
+    return true;
+#endif
+}
+
+void ShmPublisher::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    cv_.notify_all();
+
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+#ifndef _WIN32
+    if (segment_) {
+        // Left in place for the next run; readers see that nobody is updating it
+        ShmTime time;
+        shm_time_read(*segment_, time);
+        time.state = ShmTimeState::STOPPED;
+        time.leap = NTPPacket::LEAP_ALARM;
+        shm_time_write(*segment_, time);
+
+        munmap(segment_, sizeof(ShmTimeSegment));
+        segment_ = nullptr;
+    }
+#endif
+}
+
+void ShmPublisher::publish() {
+    const TimeSource& source = TimeSource::instance();
+
+    ShmTime time;
+    time.offset_ns = source.offset_ns();
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count() + time.offset_ns;
+    time.seconds = now / NS_PER_SECOND;
+    time.nanoseconds = static_cast<uint32_t>(now % NS_PER_SECOND);
+
+    // Same leap and error reporting as the NTP responder
+    time.state = ShmTimeState::LOCAL;
+    time.leap = NTPPacket::LEAP_NONE;
+    if (synchronizer_) {
+        if (synchronizer_->is_synchronized()) {
+            time.state = ShmTimeState::SYNCHRONIZED;
+            time.max_error_ns = synchronizer_->get_root_delay_ns() / 2 + synchronizer_->get_root_dispersion_ns();
+        } else {
+            time.state = ShmTimeState::UNSYNCHRONIZED;
+            time.leap = NTPPacket::LEAP_ALARM;
+        }
+    }
+
+    shm_time_write(*segment_, time);
+}
+
+void ShmPublisher::thread_main() {
+    auto interval = std::chrono::milliseconds(UPDATE_INTERVAL_MS);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+        cv_.wait_for(lock, interval, [this] { return !running_; });
+        if (!running_) {
+            break;
+        }
+        publish();
+    }
+}
+
+} // namespace simple_utcd
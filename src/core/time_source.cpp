@@ -0,0 +1,191 @@
+/*
+ * src/core/time_source.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simple_utcd/time_source.hpp"
+#include <chrono>
+#include <cstring>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <arpa/inet.h>
+#include <time.h>
+#endif
+
+namespace simple_utcd {
+
+namespace {
+
+// Consecutive on-time ticks required before the cache is trusted again
+constexpr int RECOVERY_TICKS = 2;
+
+uint64_t pack(uint32_t seconds, uint32_t deadline_ms) {
+    return (static_cast<uint64_t>(seconds) << 32) | deadline_ms;
+}
+
+// Read on every cached lookup, so the cheapest monotonic clock will do; a few ms of resolution is plenty
+uint32_t coarse_ms() {
+#ifdef CLOCK_MONOTONIC_COARSE
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return static_cast<uint32_t>(static_cast<uint64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000);
+#else
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(now).count());
+#endif
+}
+
+std::chrono::system_clock::time_point corrected(std::chrono::system_clock::time_point now, int64_t offset) {
+    return now + std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(offset));
+}
+
+} // namespace
+
+TimeSource& TimeSource::instance() {
+    static TimeSource source;
+    return source;
+}
+
+TimeSource::TimeSource()
+    : offset_ns_(0)
+    , running_(false)
+{
+}
+
+TimeSource::~TimeSource() {
+    stop();
+}
+
+void TimeSource::start() {
+    std::lock_guard<std::mutex> lock(ticker_mutex_);
+    if (running_) {
+        return;
+    }
+
+    running_ = true;
+    publish();
+    ticker_ = std::thread(&TimeSource::ticker_main, this);
+}
+
+void TimeSource::stop() {
+    {
+        std::lock_guard<std::mutex> lock(ticker_mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    ticker_cv_.notify_all();
+
+    if (ticker_.joinable()) {
+        ticker_.join();
+    }
+    cell_.packed.store(0, std::memory_order_relaxed);
+}
+
+bool TimeSource::is_ticker_healthy() const {
+    return running_.load(std::memory_order_relaxed) && cached_seconds() != 0;
+}
+
+uint32_t TimeSource::cached_seconds() const {
+    uint64_t packed = cell_.packed.load(std::memory_order_relaxed);
+    if (packed == 0) {
+        return 0;
+    }
+
+    // A ticker that stopped waking up leaves a second that is no longer current
+    uint32_t deadline = static_cast<uint32_t>(packed);
+    if (static_cast<int32_t>(deadline - coarse_ms()) < 0) {
+        return 0;
+    }
+    return static_cast<uint32_t>(packed >> 32);
+}
+
+uint32_t TimeSource::now_seconds() const {
+    uint32_t seconds = cached_seconds();
+    return seconds != 0 ? seconds : read_clock();
+}
+
+std::array<uint8_t, 4> TimeSource::current_reply() const {
+    uint32_t wire = htonl(now_seconds());
+    std::array<uint8_t, 4> reply;
+    memcpy(reply.data(), &wire, reply.size());
+    return reply;
+}
+
+uint32_t TimeSource::read_clock() const {
+    auto now = corrected(std::chrono::system_clock::now(), offset_ns());
+    return static_cast<uint32_t>(std::chrono::system_clock::to_time_t(now));
+}
+
+void TimeSource::set_offset_ns(int64_t offset) {
+    offset_ns_.store(offset, std::memory_order_relaxed);
+
+    // Don't leave a stepped-away second in the cell until the next tick
+    if (cell_.packed.load(std::memory_order_relaxed) != 0) {
+        publish();
+    }
+}
+
+void TimeSource::publish() {
+    // Good until the next second of the corrected clock, plus the lateness a tick is allowed
+    auto now = corrected(std::chrono::system_clock::now(), offset_ns());
+    auto second = std::chrono::time_point_cast<std::chrono::seconds>(now);
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(second + std::chrono::seconds(1) - now);
+    uint32_t deadline = coarse_ms() + static_cast<uint32_t>(remaining.count()) + LAG_TOLERANCE_MS;
+    cell_.packed.store(pack(static_cast<uint32_t>(std::chrono::system_clock::to_time_t(now)), deadline),
+                       std::memory_order_relaxed);
+}
+
+void TimeSource::ticker_main() {
+    using clock = std::chrono::system_clock;
+    int on_time = RECOVERY_TICKS;
+
+    std::unique_lock<std::mutex> lock(ticker_mutex_);
+    while (running_) {
+        // Sleep until the next whole second of the corrected clock
+        int64_t offset = offset_ns();
+        auto now = corrected(clock::now(), offset);
+        auto boundary = std::chrono::time_point_cast<std::chrono::seconds>(now) + std::chrono::seconds(1);
+        ticker_cv_.wait_until(lock, corrected(boundary, -offset), [this] { return !running_; });
+        if (!running_) {
+            break;
+        }
+
+        now = corrected(clock::now(), offset_ns());
+        auto lateness = std::chrono::duration_cast<std::chrono::milliseconds>(now - boundary).count();
+
+        if (lateness > LAG_TOLERANCE_MS) {
+            // The cell was stale for part of that interval; make readers go direct for a while
+            on_time = 0;
+            cell_.packed.store(0, std::memory_order_relaxed);
+            continue;
+        }
+
+        if (on_time < RECOVERY_TICKS) {
+            on_time++;
+            if (on_time < RECOVERY_TICKS) {
+                continue;
+            }
+        }
+
+        publish();
+    }
+}
+
+} // namespace simple_utcd
@@ -0,0 +1,547 @@
+/*
+ * src/core/time_synchronizer.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simple_utcd/time_synchronizer.hpp"
+#include "simple_utcd/utc_config.hpp"
+#include "simple_utcd/logger.hpp"
+#include "simple_utcd/platform.hpp"
+#include "simple_utcd/time_source.hpp"
+#include "simple_utcd/ntp_packet.hpp"
+#include "simple_utcd/utc_packet.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/socket.h>
+#include <netdb.h>
+#include <poll.h>
+#endif
+
+namespace simple_utcd {
+
+namespace {
+
+constexpr int64_t NS_PER_SECOND = 1000000000;
+
+constexpr size_t RFC868_PACKET_SIZE = 4;
+
+constexpr uint8_t SNTP_REQUEST = NTPPacket::make_flags(NTPPacket::LEAP_NONE, 4, NTPPacket::MODE_CLIENT);
+
+// Upstream host names are looked up again this often
+constexpr int64_t RESOLVE_INTERVAL_MS = 3600 * 1000;
+
+// An RFC 868 answer is truncated to the second it was sent in
+constexpr int64_t RFC868_RESOLUTION_NS = NS_PER_SECOND;
+
+struct Probe {
+    size_t source = 0;
+    Upstream::Protocol protocol = Upstream::Protocol::SNTP;
+    int fd = -1;
+    bool connecting = false;
+    int64_t sent_ns = 0;
+    uint64_t origin = 0;
+    uint8_t buffer[NTPPacket::PACKET_SIZE];
+    size_t received = 0;
+};
+
+int64_t wall_ns() {
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
+int64_t steady_ms() {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(now).count();
+}
+
+bool parse_port(const std::string& text, int& port) {
+    if (text.empty() || text.size() > 5 ||
+        !std::all_of(text.begin(), text.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+        return false;
+    }
+    port = std::stoi(text);
+    return port > 0 && port <= 65535;
+}
+
+} // namespace
+
+bool Upstream::parse(const std::string& spec, Upstream& upstream) {
+    upstream = Upstream();
+    upstream.spec = spec;
+
+    std::string rest = spec;
+    size_t scheme_end = rest.find("://");
+    if (scheme_end != std::string::npos) {
+        std::string scheme = rest.substr(0, scheme_end);
+        rest = rest.substr(scheme_end + 3);
+        if (scheme == "ntp" || scheme == "sntp") {
+            upstream.protocol = Protocol::SNTP;
+        } else if (scheme == "time") {
+            upstream.protocol = Protocol::TIME_TCP;
+            upstream.port = 37;
+        } else if (scheme == "time-udp") {
+            upstream.protocol = Protocol::TIME_UDP;
+            upstream.port = 37;
+        } else {
+            return false;
+        }
+    }
+
+    if (!rest.empty() && rest[0] == '[') {
+        // [IPv6 literal] with an optional :port
+        size_t close = rest.find(']');
+        if (close == std::string::npos) {
+            return false;
+        }
+        upstream.host = rest.substr(1, close - 1);
+        std::string tail = rest.substr(close + 1);
+        if (!tail.empty() && (tail[0] != ':' || !parse_port(tail.substr(1), upstream.port))) {
+            return false;
+        }
+    } else {
+        // A single colon separates the port; more than one is a bare IPv6 literal
+        size_t colon = rest.rfind(':');
+        if (colon != std::string::npos && rest.find(':') == colon) {
+            upstream.host = rest.substr(0, colon);
+            if (!parse_port(rest.substr(colon + 1), upstream.port)) {
+                return false;
+            }
+        } else {
+            upstream.host = rest;
+        }
+    }
+
+    return !upstream.host.empty();
+}
+
+TimeSynchronizer::TimeSynchronizer(const UTCConfig* config, Logger* logger)
+    : config_(config)
+    , logger_(logger)
+    , max_step_ns_(static_cast<int64_t>(std::max(0, config->get_max_step())) * NS_PER_SECOND)
+    , offset_ns_(0)
+    , synchronized_(false)
+    , reachable_(0)
+    , root_delay_ns_(0)
+    , root_dispersion_ns_(0)
+    , reference_time_ns_(0)
+    , running_(false)
+    , poll_requested_(false)
+{
+    for (const auto& spec : config_->get_upstream_servers()) {
+        Source source;
+        if (Upstream::parse(spec, source.upstream)) {
+            upstreams_.push_back(std::move(source));
+        } else if (logger_) {
+            logger_->warn("Ignoring invalid upstream server '{}'", spec);
+        }
+    }
+
+    // Address literals are usable at once; names wait for the sync thread
+    resolve_upstreams(true);
+}
+
+TimeSynchronizer::~TimeSynchronizer() {
+    stop();
+}
+
+bool TimeSynchronizer::start() {
+    if (upstreams_.empty()) {
+        if (logger_) {
+            logger_->warn("Upstream sync enabled but no usable upstream_servers; serving the system clock");
+        }
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_) {
+            return false;
+        }
+        running_ = true;
+    }
+    thread_ = std::thread(&TimeSynchronizer::thread_main, this);
+
+    if (logger_) {
+        logger_->info("Synchronizing with {} upstream servers every {}s",
+                     upstreams_.size(), config_->get_sync_interval());
+    }
+    return true;
+}
+
+void TimeSynchronizer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    cv_.notify_all();
+
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void TimeSynchronizer::request_poll() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        poll_requested_ = true;
+    }
+    cv_.notify_all();
+}
+
+void TimeSynchronizer::thread_main() {
+    auto interval = std::chrono::seconds(std::max(1, config_->get_sync_interval()));
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+        poll_requested_ = false;
+        lock.unlock();
+        resolve_upstreams(false);
+        poll_once();
+        lock.lock();
+
+        cv_.wait_for(lock, interval, [this] { return !running_ || poll_requested_; });
+    }
+}
+
+void TimeSynchronizer::resolve_upstreams(bool numeric_only) {
+    int64_t now = steady_ms();
+    for (auto& source : upstreams_) {
+        if (source.literal || (source.address_length > 0 && now - source.resolved_ms < RESOLVE_INTERVAL_MS)) {
+            continue;
+        }
+
+        struct addrinfo hints;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = source.upstream.protocol == Upstream::Protocol::TIME_TCP ? SOCK_STREAM : SOCK_DGRAM;
+        hints.ai_flags = numeric_only ? AI_NUMERICHOST : 0;
+
+        struct addrinfo* result = nullptr;
+        std::string port = std::to_string(source.upstream.port);
+        if (getaddrinfo(source.upstream.host.c_str(), port.c_str(), &hints, &result) != 0 || !result) {
+            // A failed refresh keeps polling the old address and tries again next round
+            if (!numeric_only && logger_) {
+                logger_->debug("Upstream {}: cannot resolve {}", source.upstream.spec, source.upstream.host);
+            }
+            continue;
+        }
+
+        memcpy(&source.address, result->ai_addr, result->ai_addrlen);
+        source.address_length = static_cast<socklen_t>(result->ai_addrlen);
+        source.resolved_ms = now;
+        source.literal = numeric_only;
+        freeaddrinfo(result);
+    }
+}
+
+size_t TimeSynchronizer::poll_once() {
+    std::vector<Probe> probes;
+    probes.reserve(upstreams_.size());
+
+    // Send every request before waiting on any answer
+    for (size_t i = 0; i < upstreams_.size(); ++i) {
+        Source& source = upstreams_[i];
+        source.reach = static_cast<uint8_t>(source.reach << 1);
+
+        if (source.address_length == 0) {
+            // Not resolved yet; the sync thread keeps trying between rounds
+            continue;
+        }
+
+        bool stream = source.upstream.protocol == Upstream::Protocol::TIME_TCP;
+        Probe probe;
+        probe.source = i;
+        probe.protocol = source.upstream.protocol;
+        probe.fd = Platform::create_socket(source.address.ss_family, stream ? SOCK_STREAM : SOCK_DGRAM, 0);
+
+        bool ok = probe.fd >= 0 && Platform::set_nonblocking(probe.fd);
+        if (ok) {
+            // Connected datagram sockets only hear back from the upstream itself
+            int rc = connect(probe.fd, reinterpret_cast<const struct sockaddr*>(&source.address),
+                             source.address_length);
+            probe.sent_ns = wall_ns();
+            if (stream) {
+                ok = rc == 0 || errno == EINPROGRESS;
+                probe.connecting = true;
+            } else if (rc != 0) {
+                ok = false;
+            } else if (probe.protocol == Upstream::Protocol::SNTP) {
+                uint8_t request[NTPPacket::PACKET_SIZE] = {};
+                request[0] = SNTP_REQUEST;
+                probe.origin = NTPPacket::to_timestamp(probe.sent_ns);
+                NTPPacket::store_be64(probe.origin, request + NTPPacket::OFFSET_TRANSMIT_TIME);
+                ok = send(probe.fd, request, sizeof(request), 0) == static_cast<ssize_t>(sizeof(request));
+            } else {
+                // RFC 868 over UDP: an empty datagram asks for the time
+                ok = send(probe.fd, probe.buffer, 0, 0) == 0;
+            }
+        }
+
+        if (!ok) {
+            if (logger_) {
+                logger_->debug("Upstream {}: request failed: {}", source.upstream.spec, strerror(errno));
+            }
+            if (probe.fd >= 0) {
+                Platform::close_socket(probe.fd);
+            }
+            continue;
+        }
+        probes.push_back(probe);
+    }
+
+    size_t answered = 0;
+    size_t pending = probes.size();
+    int64_t deadline = steady_ms() + std::max(1, config_->get_timeout());
+    std::vector<struct pollfd> fds;
+    std::vector<Probe*> owners;
+
+    auto finish = [&pending](Probe& probe) {
+        Platform::close_socket(probe.fd);
+        probe.fd = -1;
+        pending--;
+    };
+
+    while (pending > 0) {
+        int64_t remaining = deadline - steady_ms();
+        if (remaining <= 0) {
+            break;
+        }
+
+        fds.clear();
+        owners.clear();
+        for (auto& probe : probes) {
+            if (probe.fd >= 0) {
+                struct pollfd pfd;
+                pfd.fd = probe.fd;
+                pfd.events = probe.connecting ? POLLOUT : POLLIN;
+                pfd.revents = 0;
+                fds.push_back(pfd);
+                owners.push_back(&probe);
+            }
+        }
+
+        int ready = poll(fds.data(), fds.size(), static_cast<int>(remaining));
+        if (ready < 0 && errno != EINTR) {
+            break;
+        }
+
+        for (size_t i = 0; i < fds.size() && ready > 0; ++i) {
+            if (fds[i].revents == 0) {
+                continue;
+            }
+            Probe& probe = *owners[i];
+            Source& source = upstreams_[probe.source];
+
+            if (probe.connecting) {
+                int error = 0;
+                socklen_t length = sizeof(error);
+                if (getsockopt(probe.fd, SOL_SOCKET, SO_ERROR, &error, &length) != 0 || error != 0) {
+                    finish(probe);
+                } else {
+                    probe.connecting = false;
+                }
+                continue;
+            }
+
+            bool stream = probe.protocol == Upstream::Protocol::TIME_TCP;
+            size_t want = stream ? RFC868_PACKET_SIZE - probe.received : sizeof(probe.buffer);
+            auto received = recv(probe.fd, probe.buffer + probe.received, want, 0);
+            int64_t t4 = wall_ns();
+            if (received < 0 && Platform::would_block()) {
+                continue;
+            }
+            if (received <= 0) {
+                finish(probe);
+                continue;
+            }
+            probe.received += static_cast<size_t>(received);
+            if (stream && probe.received < RFC868_PACKET_SIZE) {
+                continue;
+            }
+
+            TimeSample sample;
+            bool valid = probe.protocol == Upstream::Protocol::SNTP
+                ? sntp_sample(probe.buffer, probe.received, probe.origin, probe.sent_ns, t4, sample)
+                : rfc868_sample(probe.buffer, probe.received, probe.sent_ns, t4, sample);
+            finish(probe);
+
+            if (!valid) {
+                if (logger_) {
+                    logger_->debug("Upstream {}: discarded malformed or unsynchronized reply", source.upstream.spec);
+                }
+                continue;
+            }
+
+            source.reach |= 1;
+            source.samples.push_back(sample);
+            if (source.samples.size() > FILTER_SIZE) {
+                source.samples.pop_front();
+            }
+            answered++;
+
+            if (logger_) {
+                logger_->debug("Upstream {}: offset={}ms delay={}ms", source.upstream.spec,
+                              sample.offset_ns / 1e6, sample.delay_ns / 1e6);
+            }
+        }
+    }
+
+    for (auto& probe : probes) {
+        if (probe.fd >= 0) {
+            Platform::close_socket(probe.fd);
+        }
+    }
+
+    // An upstream silent for a whole filter window no longer votes
+    for (auto& source : upstreams_) {
+        if (source.reach == 0) {
+            source.samples.clear();
+        }
+    }
+
+    reachable_.store(answered, std::memory_order_relaxed);
+    if (answered == 0 && logger_ && !upstreams_.empty()) {
+        logger_->warn("No upstream time server answered within {}ms", config_->get_timeout());
+    }
+
+    update_estimate();
+    return answered;
+}
+
+void TimeSynchronizer::update_estimate() {
+    // Each upstream votes with its lowest-delay recent sample
+    std::vector<TimeSample> votes;
+    for (const auto& source : upstreams_) {
+        if (!source.samples.empty()) {
+            votes.push_back(*std::min_element(source.samples.begin(), source.samples.end(),
+                [](const TimeSample& a, const TimeSample& b) { return a.delay_ns < b.delay_ns; }));
+        }
+    }
+    if (votes.empty()) {
+        // Hold the last estimate until an upstream comes back
+        return;
+    }
+
+    // Only votes about as precise as the best one count, so a whole-second
+    // RFC 868 answer cannot drag an SNTP estimate around
+    const TimeSample& closest = *std::min_element(votes.begin(), votes.end(),
+        [](const TimeSample& a, const TimeSample& b) { return a.distance_ns() < b.distance_ns(); });
+    int64_t best = closest.distance_ns();
+    int64_t limit = std::max(best * 2, best + 1000000);
+
+    std::vector<int64_t> offsets;
+    for (const auto& vote : votes) {
+        if (vote.distance_ns() <= limit) {
+            offsets.push_back(vote.offset_ns);
+        }
+    }
+    std::sort(offsets.begin(), offsets.end());
+    size_t middle = offsets.size() / 2;
+    int64_t target = offsets.size() % 2 ? offsets[middle] : offsets[middle - 1] + (offsets[middle] - offsets[middle - 1]) / 2;
+
+    int64_t current = offset_ns_.load(std::memory_order_relaxed);
+    int64_t next;
+    if (!synchronized_.load(std::memory_order_relaxed) || std::llabs(target - current) > STEP_THRESHOLD_NS) {
+        // Before the first sync the step is measured from the system clock
+        if (max_step_ns_ > 0 && std::llabs(target - current) > max_step_ns_) {
+            if (logger_) {
+                logger_->error("Refusing to step served time by {}s, more than max_step ({}s); check upstream_servers",
+                              (target - current) / NS_PER_SECOND, max_step_ns_ / NS_PER_SECOND);
+            }
+            return;
+        }
+        next = target;
+        if (logger_) {
+            logger_->info("Stepped served time to upstream offset {}ms ({} of {} sources)",
+                         target / 1e6, offsets.size(), votes.size());
+        }
+    } else {
+        // Small corrections are slewed in over a few polls
+        next = current + (target - current) / 4;
+    }
+
+    offset_ns_.store(next, std::memory_order_relaxed);
+    root_delay_ns_.store(closest.delay_ns, std::memory_order_relaxed);
+    root_dispersion_ns_.store(closest.error_ns, std::memory_order_relaxed);
+    reference_time_ns_.store(wall_ns() + next, std::memory_order_relaxed);
+    synchronized_.store(true, std::memory_order_relaxed);
+    TimeSource::instance().set_offset_ns(next);
+}
+
+bool TimeSynchronizer::sntp_sample(const uint8_t* packet, size_t size, uint64_t expected_origin,
+                                   int64_t t1_ns, int64_t t4_ns, TimeSample& sample) {
+    if (size < NTPPacket::PACKET_SIZE) {
+        return false;
+    }
+
+    uint8_t flags = packet[NTPPacket::OFFSET_FLAGS];
+    uint8_t version = NTPPacket::version(flags);
+    uint8_t stratum = packet[NTPPacket::OFFSET_STRATUM];
+
+    // Leap 3 is an unsynchronized server; stratum 0 is a kiss-o'-death
+    if (NTPPacket::leap(flags) == NTPPacket::LEAP_ALARM || version < 3 || version > 4 ||
+        NTPPacket::mode(flags) != NTPPacket::MODE_SERVER || stratum == 0 || stratum > 15) {
+        return false;
+    }
+
+    // The origin must echo our transmit timestamp, or this answers someone else
+    uint64_t origin = NTPPacket::load_be64(packet + NTPPacket::OFFSET_ORIGIN_TIME);
+    uint64_t receive = NTPPacket::load_be64(packet + NTPPacket::OFFSET_RECEIVE_TIME);
+    uint64_t transmit = NTPPacket::load_be64(packet + NTPPacket::OFFSET_TRANSMIT_TIME);
+    if (origin != expected_origin || transmit == 0) {
+        return false;
+    }
+
+    int64_t t2_ns = NTPPacket::from_timestamp(receive);
+    int64_t t3_ns = NTPPacket::from_timestamp(transmit);
+
+    sample.offset_ns = ((t2_ns - t1_ns) + (t3_ns - t4_ns)) / 2;
+    sample.delay_ns = std::max<int64_t>(0, (t4_ns - t1_ns) - (t3_ns - t2_ns));
+    sample.error_ns = NTPPacket::from_short(UTCPacket::load_be32(packet + NTPPacket::OFFSET_ROOT_DISPERSION)) +
+                      NTPPacket::from_short(UTCPacket::load_be32(packet + NTPPacket::OFFSET_ROOT_DELAY)) / 2;
+    return true;
+}
+
+bool TimeSynchronizer::rfc868_sample(const uint8_t* packet, size_t size,
+                                     int64_t t1_ns, int64_t t4_ns, TimeSample& sample) {
+    if (size < RFC868_PACKET_SIZE) {
+        return false;
+    }
+
+    uint32_t seconds = UTCPacket::load_be32(packet);
+    if (seconds == 0) {
+        return false;
+    }
+
+    // The true time lies somewhere in the reported second; assume its middle
+    int64_t upstream_ns = NTPPacket::era_seconds_to_unix(seconds) * NS_PER_SECOND + RFC868_RESOLUTION_NS / 2;
+    sample.offset_ns = upstream_ns - (t1_ns + (t4_ns - t1_ns) / 2);
+    sample.delay_ns = std::max<int64_t>(0, t4_ns - t1_ns);
+    sample.error_ns = RFC868_RESOLUTION_NS / 2;
+    return true;
+}
+
+} // namespace simple_utcd
@@ -0,0 +1,121 @@
+/*
+ * src/core/timer_wheel.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simple_utcd/timer_wheel.hpp"
+#include <algorithm>
+#include <chrono>
+
+namespace simple_utcd {
+
+TimerWheel::TimerWheel(size_t slots, uint32_t tick_ms)
+    : tick_ms_(std::max<uint32_t>(1, tick_ms))
+    , current_tick_(now_ms() / tick_ms_)
+    , armed_(0)
+{
+    size_t size = 2;
+    while (size < slots) {
+        size <<= 1;
+    }
+    mask_ = size - 1;
+
+    // Heads must not move once lists point at them
+    slots_.resize(size);
+    for (auto& head : slots_) {
+        head.prev = &head;
+        head.next = &head;
+    }
+}
+
+void TimerWheel::schedule(Timer& timer, uint32_t delay_ms, uint64_t now_ms) {
+    if (timer.is_armed()) {
+        unlink(timer);
+        armed_--;
+    }
+
+    // Round up so a timer never fires early; always at least one tick out
+    uint64_t expires = (now_ms + delay_ms + tick_ms_ - 1) / tick_ms_;
+    timer.expires = std::max(expires, current_tick_ + 1);
+
+    Timer& head = slots_[timer.expires & mask_];
+    timer.prev = head.prev;
+    timer.next = &head;
+    head.prev->next = &timer;
+    head.prev = &timer;
+    armed_++;
+}
+
+void TimerWheel::cancel(Timer& timer) {
+    if (timer.is_armed()) {
+        unlink(timer);
+        armed_--;
+    }
+}
+
+int TimerWheel::next_timeout_ms(uint64_t now_ms) const {
+    if (armed_ == 0) {
+        return -1;
+    }
+    uint64_t next_tick_ms = (current_tick_ + 1) * tick_ms_;
+    return now_ms >= next_tick_ms ? 0 : static_cast<int>(next_tick_ms - now_ms);
+}
+
+uint64_t TimerWheel::now_ms() {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(now).count());
+}
+
+TimerWheel::Timer* TimerWheel::collect(uint64_t now_ms) {
+    uint64_t target = now_ms / tick_ms_;
+    if (target <= current_tick_) {
+        return nullptr;
+    }
+
+    // After a long stall one full revolution already visits every slot
+    if (target - current_tick_ > slots_.size()) {
+        current_tick_ = target - slots_.size();
+    }
+
+    Timer* expired = nullptr;
+    Timer** tail = &expired;
+    while (current_tick_ < target && armed_ > 0) {
+        current_tick_++;
+        Timer& head = slots_[current_tick_ & mask_];
+        Timer* timer = head.next;
+        while (timer != &head) {
+            Timer* next = timer->next;
+            if (timer->expires <= target) {
+                unlink(*timer);
+                armed_--;
+                *tail = timer;
+                tail = &timer->next;
+            }
+            timer = next;
+        }
+    }
+    current_tick_ = target;
+    return expired;
+}
+
+void TimerWheel::unlink(Timer& timer) {
+    timer.prev->next = timer.next;
+    timer.next->prev = timer.prev;
+    timer.prev = nullptr;
+    timer.next = nullptr;
+}
+
+} // namespace simple_utcd
@@ -0,0 +1,244 @@
+/*
+ * src/core/udp_batch.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simple_utcd/udp_batch.hpp"
+#include "simple_utcd/platform.hpp"
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#endif
+
+namespace simple_utcd {
+
+namespace {
+
+// Room for an SCM_TIMESTAMPING message (three timespecs) with alignment slack
+constexpr size_t CONTROL_SIZE = 128;
+
+} // namespace
+
+struct UDPBatch::Buffers {
+    std::vector<uint8_t> payload;              // capacity * buffer_size bytes
+    std::vector<struct sockaddr_storage> peers;
+    std::vector<size_t> sizes;
+    std::vector<int> reply_to;                 // request index per queued reply
+    std::vector<int64_t> receive_ns;           // kernel receive stamps, 0 if absent
+    std::vector<uint8_t> control;              // ancillary data, CONTROL_SIZE per slot
+    std::vector<struct iovec> rx_iov;
+    std::vector<struct iovec> tx_iov;
+#ifdef __linux__
+    std::vector<struct mmsghdr> rx_msgs;
+    std::vector<struct mmsghdr> tx_msgs;
+#endif
+};
+
+UDPBatch::UDPBatch(size_t capacity, size_t buffer_size, bool receive_timestamps)
+    : capacity_(capacity > 0 ? capacity : 1)
+    , buffer_size_(buffer_size > 0 ? buffer_size : 1)
+    , receive_timestamps_(receive_timestamps)
+    , buffers_(std::make_unique<Buffers>())
+    , received_(0)
+    , pending_(0)
+{
+    buffers_->payload.resize(capacity_ * buffer_size_);
+    buffers_->peers.resize(capacity_);
+    buffers_->sizes.resize(capacity_);
+    buffers_->reply_to.resize(capacity_);
+    buffers_->receive_ns.resize(capacity_);
+    buffers_->rx_iov.resize(capacity_);
+    buffers_->tx_iov.resize(capacity_);
+
+    for (size_t i = 0; i < capacity_; ++i) {
+        buffers_->rx_iov[i].iov_base = &buffers_->payload[i * buffer_size_];
+        buffers_->rx_iov[i].iov_len = buffer_size_;
+    }
+
+#ifdef __linux__
+    buffers_->rx_msgs.resize(capacity_);
+    buffers_->tx_msgs.resize(capacity_);
+    for (size_t i = 0; i < capacity_; ++i) {
+        struct msghdr& hdr = buffers_->rx_msgs[i].msg_hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        hdr.msg_name = &buffers_->peers[i];
+        hdr.msg_iov = &buffers_->rx_iov[i];
+        hdr.msg_iovlen = 1;
+    }
+    if (receive_timestamps_) {
+        buffers_->control.resize(capacity_ * CONTROL_SIZE);
+    }
+#endif
+}
+
+UDPBatch::~UDPBatch() {
+}
+
+int UDPBatch::receive(int socket_fd) {
+    received_ = 0;
+    pending_ = 0;
+
+#ifdef __linux__
+    // msg_namelen is in/out, so it has to be reset before every call
+    for (size_t i = 0; i < capacity_; ++i) {
+        buffers_->rx_msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+    }
+    if (receive_timestamps_) {
+        // msg_controllen is in/out as well
+        for (size_t i = 0; i < capacity_; ++i) {
+            buffers_->rx_msgs[i].msg_hdr.msg_control = &buffers_->control[i * CONTROL_SIZE];
+            buffers_->rx_msgs[i].msg_hdr.msg_controllen = CONTROL_SIZE;
+        }
+    }
+
+    int count = recvmmsg(socket_fd, buffers_->rx_msgs.data(), static_cast<unsigned int>(capacity_),
+                         MSG_DONTWAIT, nullptr);
+    if (count < 0) {
+        if (Platform::would_block() || errno == EINTR) {
+            return 0;
+        }
+        Platform::set_last_error("recvmmsg() failed: " + std::string(strerror(errno)));
+        return -1;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        buffers_->sizes[i] = buffers_->rx_msgs[i].msg_len;
+        buffers_->receive_ns[i] = 0;
+    }
+
+    if (receive_timestamps_) {
+        for (int i = 0; i < count; ++i) {
+            buffers_->receive_ns[i] = Platform::receive_timestamp_ns(buffers_->rx_msgs[i].msg_hdr);
+        }
+    }
+    received_ = static_cast<size_t>(count);
+#else
+    while (received_ < capacity_) {
+        socklen_t peer_len = sizeof(struct sockaddr_storage);
+        auto received = recvfrom(socket_fd, reinterpret_cast<char*>(buffers_->rx_iov[received_].iov_base),
+                                 static_cast<int>(buffer_size_), 0,
+                                 reinterpret_cast<struct sockaddr*>(&buffers_->peers[received_]), &peer_len);
+        if (received < 0) {
+            if (Platform::would_block() || received_ > 0) {
+                break;
+            }
+            Platform::set_last_error("recvfrom() failed: " + std::string(strerror(errno)));
+            return -1;
+        }
+        buffers_->sizes[received_] = static_cast<size_t>(received);
+        buffers_->receive_ns[received_] = 0;
+        received_++;
+    }
+#endif
+
+    return static_cast<int>(received_);
+}
+
+const uint8_t* UDPBatch::data(int index) const {
+    return &buffers_->payload[static_cast<size_t>(index) * buffer_size_];
+}
+
+uint8_t* UDPBatch::mutable_data(int index) {
+    return &buffers_->payload[static_cast<size_t>(index) * buffer_size_];
+}
+
+size_t UDPBatch::size(int index) const {
+    return buffers_->sizes[index];
+}
+
+const struct sockaddr_storage& UDPBatch::peer(int index) const {
+    return buffers_->peers[index];
+}
+
+int64_t UDPBatch::receive_time_ns(int index) const {
+    return buffers_->receive_ns[index];
+}
+
+void UDPBatch::add_reply(int index, const void* data, size_t size) {
+    if (pending_ >= capacity_) {
+        return;
+    }
+
+    buffers_->reply_to[pending_] = index;
+    buffers_->tx_iov[pending_].iov_base = const_cast<void*>(data);
+    buffers_->tx_iov[pending_].iov_len = size;
+
+#ifdef __linux__
+    struct msghdr& hdr = buffers_->tx_msgs[pending_].msg_hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.msg_name = &buffers_->peers[index];
+    hdr.msg_namelen = buffers_->rx_msgs[index].msg_hdr.msg_namelen;
+    hdr.msg_iov = &buffers_->tx_iov[pending_];
+    hdr.msg_iovlen = 1;
+#endif
+
+    pending_++;
+}
+
+uint8_t* UDPBatch::reply_data(size_t reply) {
+    return static_cast<uint8_t*>(buffers_->tx_iov[reply].iov_base);
+}
+
+int UDPBatch::send_replies(int socket_fd) {
+    size_t sent = 0;
+
+#ifdef __linux__
+    size_t next = 0;
+    while (next < pending_) {
+        int count = sendmmsg(socket_fd, &buffers_->tx_msgs[next],
+                             static_cast<unsigned int>(pending_ - next), MSG_DONTWAIT);
+        if (count < 0) {
+            int error = errno;
+            if (error == EINTR) {
+                continue;
+            }
+            Platform::set_last_error("sendmmsg() failed: " + std::string(strerror(error)));
+            if (error == EAGAIN || error == EWOULDBLOCK) {
+                break;  // socket buffer full, drop the rest of the batch
+            }
+            next++;     // the reply at 'next' was rejected, carry on with the others
+            continue;
+        }
+        next += static_cast<size_t>(count);
+        sent += static_cast<size_t>(count);
+    }
+#else
+    for (size_t i = 0; i < pending_; ++i) {
+        const struct sockaddr_storage& peer = buffers_->peers[buffers_->reply_to[i]];
+        socklen_t peer_len = peer.ss_family == AF_INET6 ? sizeof(struct sockaddr_in6)
+                                                         : sizeof(struct sockaddr_in);
+        auto result = sendto(socket_fd, reinterpret_cast<const char*>(buffers_->tx_iov[i].iov_base),
+                             static_cast<int>(buffers_->tx_iov[i].iov_len), 0,
+                             reinterpret_cast<const struct sockaddr*>(&peer), peer_len);
+        if (result >= 0) {
+            sent++;
+        }
+    }
+#endif
+
+    pending_ = 0;
+    return static_cast<int>(sent);
+}
+
+} // namespace simple_utcd
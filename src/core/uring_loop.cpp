@@ -0,0 +1,204 @@
+/*
+ * src/core/uring_loop.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simple_utcd/uring_loop.hpp"
+
+#ifdef SIMPLE_UTCD_HAVE_IO_URING
+#include <cerrno>
+#include <liburing.h>
+#include <sys/uio.h>
+#endif
+
+namespace simple_utcd {
+
+#ifdef SIMPLE_UTCD_HAVE_IO_URING
+
+struct UringLoop::Ring {
+    struct io_uring ring;
+    bool valid = false;
+};
+
+namespace {
+
+// A full submission queue is flushed to make room rather than failing the request
+struct io_uring_sqe* next_sqe(struct io_uring* ring) {
+    struct io_uring_sqe* sqe = io_uring_get_sqe(ring);
+    if (!sqe && io_uring_submit(ring) >= 0) {
+        sqe = io_uring_get_sqe(ring);
+    }
+    return sqe;
+}
+
+} // namespace
+
+UringLoop::UringLoop(unsigned entries)
+    : ring_(std::make_unique<Ring>())
+{
+    // The completion queue is twice the submission queue by default; accepts and writes share it
+    unsigned size = entries > 0 ? entries : 1;
+    ring_->valid = io_uring_queue_init(size, &ring_->ring, 0) == 0;
+    completions_.resize(size * 2);
+}
+
+UringLoop::~UringLoop() {
+    if (ring_->valid) {
+        io_uring_queue_exit(&ring_->ring);
+    }
+}
+
+bool UringLoop::is_supported() {
+    struct io_uring ring;
+    struct io_uring_params params = {};
+    if (io_uring_queue_init_params(4, &ring, &params) != 0) {
+        return false;
+    }
+
+    // IORING_OP_SOCKET shipped in the same release as multishot accept (5.19)
+    bool supported = (params.features & IORING_FEAT_CQE_SKIP) != 0;
+    struct io_uring_probe* probe = io_uring_get_probe_ring(&ring);
+    if (probe) {
+        supported = supported &&
+            io_uring_opcode_supported(probe, IORING_OP_ACCEPT) &&
+            io_uring_opcode_supported(probe, IORING_OP_WRITE_FIXED) &&
+            io_uring_opcode_supported(probe, IORING_OP_CLOSE) &&
+            io_uring_opcode_supported(probe, IORING_OP_SOCKET);
+        io_uring_free_probe(probe);
+    } else {
+        supported = false;
+    }
+
+    io_uring_queue_exit(&ring);
+    return supported;
+}
+
+bool UringLoop::is_valid() const {
+    return ring_->valid;
+}
+
+bool UringLoop::register_buffer(void* data, size_t size) {
+    struct iovec iov;
+    iov.iov_base = data;
+    iov.iov_len = size;
+    return io_uring_register_buffers(&ring_->ring, &iov, 1) == 0;
+}
+
+bool UringLoop::accept_multishot(int listen_fd, uint64_t user_data) {
+    struct io_uring_sqe* sqe = next_sqe(&ring_->ring);
+    if (!sqe) {
+        return false;
+    }
+    // No address: one shared buffer would be overwritten by later accepts before we read it
+    io_uring_prep_multishot_accept(sqe, listen_fd, nullptr, nullptr, 0);
+    io_uring_sqe_set_data64(sqe, user_data);
+    return true;
+}
+
+bool UringLoop::write_fixed_and_close(int fd, const uint8_t* data, size_t size,
+                                      uint64_t user_data, uint64_t close_data) {
+    // Both entries must land in the same submission for the link to hold
+    if (io_uring_sq_space_left(&ring_->ring) < 2 && io_uring_submit(&ring_->ring) < 0) {
+        return false;
+    }
+
+    struct io_uring_sqe* write = io_uring_get_sqe(&ring_->ring);
+    struct io_uring_sqe* close = io_uring_get_sqe(&ring_->ring);
+    if (!write || !close) {
+        return false;
+    }
+
+    io_uring_prep_write_fixed(write, fd, data, static_cast<unsigned>(size), 0, 0);
+    io_uring_sqe_set_data64(write, user_data);
+    io_uring_sqe_set_flags(write, IOSQE_IO_HARDLINK);
+
+    io_uring_prep_close(close, fd);
+    io_uring_sqe_set_data64(close, close_data);
+    io_uring_sqe_set_flags(close, IOSQE_CQE_SKIP_SUCCESS);
+    return true;
+}
+
+int UringLoop::wait(int timeout_ms) {
+    struct __kernel_timespec timeout;
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_nsec = static_cast<long long>(timeout_ms % 1000) * 1000000;
+
+    struct io_uring_cqe* cqe = nullptr;
+    int result = io_uring_submit_and_wait_timeout(&ring_->ring, &cqe, 1, timeout_ms >= 0 ? &timeout : nullptr, nullptr);
+    if (result < 0 && result != -ETIME && result != -EINTR) {
+        return -1;
+    }
+
+    // Copy out and release the slots at once so the kernel never sees a full queue on our account
+    int count = 0;
+    unsigned head;
+    io_uring_for_each_cqe(&ring_->ring, head, cqe) {
+        if (static_cast<size_t>(count) == completions_.size()) {
+            break;
+        }
+        completions_[static_cast<size_t>(count)] = {cqe->user_data, cqe->res, cqe->flags};
+        count++;
+    }
+    io_uring_cq_advance(&ring_->ring, static_cast<unsigned>(count));
+    return count;
+}
+
+bool UringLoop::has_more(uint32_t flags) {
+    return (flags & IORING_CQE_F_MORE) != 0;
+}
+
+#else
+
+struct UringLoop::Ring {};
+
+UringLoop::UringLoop(unsigned)
+    : ring_(std::make_unique<Ring>())
+{
+}
+
+UringLoop::~UringLoop() = default;
+
+bool UringLoop::is_supported() {
+    return false;
+}
+
+bool UringLoop::is_valid() const {
+    return false;
+}
+
+bool UringLoop::register_buffer(void*, size_t) {
+    return false;
+}
+
+bool UringLoop::accept_multishot(int, uint64_t) {
+    return false;
+}
+
+bool UringLoop::write_fixed_and_close(int, const uint8_t*, size_t, uint64_t, uint64_t) {
+    return false;
+}
+
+int UringLoop::wait(int) {
+    return -1;
+}
+
+bool UringLoop::has_more(uint32_t) {
+    return false;
+}
+
+#endif
+
+} // namespace simple_utcd
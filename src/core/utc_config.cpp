@@ -17,6 +17,7 @@
  */
 
 #include "simple_utcd/utc_config.hpp"
+#include "simple_utcd/access_control.hpp"
 #include <fstream>
 #include <sstream>
 #include <algorithm>
@@ -38,6 +39,13 @@ void UTCConfig::set_defaults() {
     listen_port_ = 37;  // UTC protocol port
     enable_ipv6_ = true;
     max_connections_ = 1000;
+    connection_timeout_ = 5000;
+    close_strategy_ = CloseStrategy::NORMAL;
+    close_wait_timeout_ = 1000;
+    listen_backlog_ = 0;
+    socket_buffer_size_ = 0;
+    enable_tcp_fastopen_ = false;
+    tcp_fastopen_queue_size_ = 256;
 
     // UTC Server Configuration
     stratum_ = 2;
@@ -46,12 +54,21 @@ void UTCConfig::set_defaults() {
     upstream_servers_ = {"time.nist.gov", "time.google.com", "pool.ntp.org"};
     sync_interval_ = 64;
     timeout_ = 1000;
+    max_step_ = 1000;
+    enable_upstream_sync_ = false;
+    enable_shm_time_ = false;
+    shm_time_name_ = "/simple-utcd-time";
 
     // Logging Configuration
     log_file_ = "/var/log/simple-utcd/simple-utcd.log";
     log_level_ = "INFO";
     enable_console_logging_ = true;
     enable_syslog_ = false;
+    log_async_ = false;
+    log_queue_size_ = 4096;
+    log_flush_interval_ = 200;
+    log_flush_size_ = 65536;
+    log_overflow_policy_ = "drop";
 
     // Security Configuration
     enable_authentication_ = false;
@@ -59,12 +76,34 @@ void UTCConfig::set_defaults() {
     restrict_queries_ = false;
     allowed_clients_ = {};
     denied_clients_ = {};
+    enable_rate_limiting_ = false;
+    rate_limit_requests_per_minute_ = 1000;
+    rate_limit_burst_size_ = 100;
+    rate_limit_table_size_ = 65536;
 
     // Performance Configuration
     worker_threads_ = 4;
     max_packet_size_ = 1024;
     enable_statistics_ = true;
     stats_interval_ = 60;
+    enable_detailed_stats_ = false;
+    admin_port_ = 0;
+    admin_address_ = "127.0.0.1";
+    io_backend_ = "epoll";
+    event_batch_size_ = 64;
+    enable_so_reuseport_ = false;
+    enable_cpu_affinity_ = false;
+    enable_udp_ = false;
+    udp_batch_size_ = 32;
+    enable_ntp_ = false;
+    ntp_port_ = 123;
+    enable_kernel_timestamps_ = true;
+    enable_tx_timestamps_ = false;
+    enable_reply_on_accept_ = true;
+    enable_memory_pooling_ = true;
+    memory_pool_size_ = 1048576;
+
+    compile_access_control();
 }
 
 bool UTCConfig::load(const std::string& config_file) {
@@ -92,9 +131,29 @@ bool UTCConfig::load(const std::string& config_file) {
     }
 
     file.close();
+    compile_access_control();
     return true;
 }
 
+void UTCConfig::set_query_restriction_enabled(bool enabled) {
+    restrict_queries_ = enabled;
+    compile_access_control();
+}
+
+void UTCConfig::set_allowed_clients(const std::vector<std::string>& clients) {
+    allowed_clients_ = clients;
+    compile_access_control();
+}
+
+void UTCConfig::set_denied_clients(const std::vector<std::string>& clients) {
+    denied_clients_ = clients;
+    compile_access_control();
+}
+
+void UTCConfig::compile_access_control() {
+    access_control_ = std::make_shared<const AccessControl>(allowed_clients_, denied_clients_, restrict_queries_);
+}
+
 bool UTCConfig::save(const std::string& config_file) {
     std::ofstream file(config_file);
     if (!file.is_open()) {
@@ -109,7 +168,14 @@ bool UTCConfig::save(const std::string& config_file) {
     file << "listen_address = " << listen_address_ << "\n";
     file << "listen_port = " << listen_port_ << "\n";
     file << "enable_ipv6 = " << (enable_ipv6_ ? "true" : "false") << "\n";
-    file << "max_connections = " << max_connections_ << "\n\n";
+    file << "max_connections = " << max_connections_ << "\n";
+    file << "connection_timeout = " << connection_timeout_ << "\n";
+    file << "close_strategy = " << close_strategy_name(close_strategy_) << "\n";
+    file << "close_wait_timeout = " << close_wait_timeout_ << "\n";
+    file << "listen_backlog = " << listen_backlog_ << "\n";
+    file << "socket_buffer_size = " << socket_buffer_size_ << "\n";
+    file << "enable_tcp_fastopen = " << (enable_tcp_fastopen_ ? "true" : "false") << "\n";
+    file << "tcp_fastopen_queue_size = " << tcp_fastopen_queue_size_ << "\n\n";
 
     // UTC Server Configuration
     file << "# UTC Server Configuration\n";
@@ -123,14 +189,23 @@ bool UTCConfig::save(const std::string& config_file) {
     }
     file << "]\n";
     file << "sync_interval = " << sync_interval_ << "\n";
-    file << "timeout = " << timeout_ << "\n\n";
+    file << "timeout = " << timeout_ << "\n";
+    file << "max_step = " << max_step_ << "\n";
+    file << "enable_upstream_sync = " << (enable_upstream_sync_ ? "true" : "false") << "\n";
+    file << "enable_shm_time = " << (enable_shm_time_ ? "true" : "false") << "\n";
+    file << "shm_time_name = " << shm_time_name_ << "\n\n";
 
     // Logging Configuration
     file << "# Logging Configuration\n";
     file << "log_file = " << log_file_ << "\n";
     file << "log_level = " << log_level_ << "\n";
     file << "enable_console_logging = " << (enable_console_logging_ ? "true" : "false") << "\n";
-    file << "enable_syslog = " << (enable_syslog_ ? "true" : "false") << "\n\n";
+    file << "enable_syslog = " << (enable_syslog_ ? "true" : "false") << "\n";
+    file << "log_async = " << (log_async_ ? "true" : "false") << "\n";
+    file << "log_queue_size = " << log_queue_size_ << "\n";
+    file << "log_flush_interval = " << log_flush_interval_ << "\n";
+    file << "log_flush_size = " << log_flush_size_ << "\n";
+    file << "log_overflow_policy = " << log_overflow_policy_ << "\n\n";
 
     // Security Configuration
     file << "# Security Configuration\n";
@@ -148,14 +223,34 @@ bool UTCConfig::save(const std::string& config_file) {
         if (i > 0) file << ", ";
         file << "\"" << denied_clients_[i] << "\"";
     }
-    file << "]\n\n";
+    file << "]\n";
+    file << "enable_rate_limiting = " << (enable_rate_limiting_ ? "true" : "false") << "\n";
+    file << "rate_limit_requests_per_minute = " << rate_limit_requests_per_minute_ << "\n";
+    file << "rate_limit_burst_size = " << rate_limit_burst_size_ << "\n";
+    file << "rate_limit_table_size = " << rate_limit_table_size_ << "\n\n";
 
     // Performance Configuration
     file << "# Performance Configuration\n";
     file << "worker_threads = " << worker_threads_ << "\n";
     file << "max_packet_size = " << max_packet_size_ << "\n";
     file << "enable_statistics = " << (enable_statistics_ ? "true" : "false") << "\n";
-    file << "stats_interval = " << stats_interval_ << "\n\n";
+    file << "stats_interval = " << stats_interval_ << "\n";
+    file << "enable_detailed_stats = " << (enable_detailed_stats_ ? "true" : "false") << "\n";
+    file << "admin_port = " << admin_port_ << "\n";
+    file << "admin_address = " << admin_address_ << "\n";
+    file << "io_backend = " << io_backend_ << "\n";
+    file << "event_batch_size = " << event_batch_size_ << "\n";
+    file << "enable_so_reuseport = " << (enable_so_reuseport_ ? "true" : "false") << "\n";
+    file << "enable_cpu_affinity = " << (enable_cpu_affinity_ ? "true" : "false") << "\n";
+    file << "enable_udp = " << (enable_udp_ ? "true" : "false") << "\n";
+    file << "udp_batch_size = " << udp_batch_size_ << "\n";
+    file << "enable_ntp = " << (enable_ntp_ ? "true" : "false") << "\n";
+    file << "ntp_port = " << ntp_port_ << "\n";
+    file << "enable_kernel_timestamps = " << (enable_kernel_timestamps_ ? "true" : "false") << "\n";
+    file << "enable_tx_timestamps = " << (enable_tx_timestamps_ ? "true" : "false") << "\n";
+    file << "enable_reply_on_accept = " << (enable_reply_on_accept_ ? "true" : "false") << "\n";
+    file << "enable_memory_pooling = " << (enable_memory_pooling_ ? "true" : "false") << "\n";
+    file << "memory_pool_size = " << memory_pool_size_ << "\n\n";
 
     file.close();
     return true;
@@ -183,6 +278,23 @@ bool UTCConfig::parse_config_line(const std::string& line) {
         enable_ipv6_ = (value == "true" || value == "1" || value == "yes");
     } else if (key == "max_connections") {
         max_connections_ = std::stoi(value);
+    } else if (key == "connection_timeout") {
+        connection_timeout_ = std::stoi(value);
+    } else if (key == "close_strategy") {
+        // Unknown names keep the plain close
+        if (!parse_close_strategy(value, close_strategy_)) {
+            close_strategy_ = CloseStrategy::NORMAL;
+        }
+    } else if (key == "close_wait_timeout") {
+        close_wait_timeout_ = std::stoi(value);
+    } else if (key == "listen_backlog") {
+        listen_backlog_ = std::stoi(value);
+    } else if (key == "socket_buffer_size") {
+        socket_buffer_size_ = std::stoi(value);
+    } else if (key == "enable_tcp_fastopen") {
+        enable_tcp_fastopen_ = (value == "true" || value == "1" || value == "yes");
+    } else if (key == "tcp_fastopen_queue_size") {
+        tcp_fastopen_queue_size_ = std::stoi(value);
     } else if (key == "stratum") {
         stratum_ = std::stoi(value);
     } else if (key == "reference_id") {
@@ -195,6 +307,14 @@ bool UTCConfig::parse_config_line(const std::string& line) {
         sync_interval_ = std::stoi(value);
     } else if (key == "timeout") {
         timeout_ = std::stoi(value);
+    } else if (key == "max_step") {
+        max_step_ = std::stoi(value);
+    } else if (key == "enable_upstream_sync") {
+        enable_upstream_sync_ = (value == "true" || value == "1" || value == "yes");
+    } else if (key == "enable_shm_time") {
+        enable_shm_time_ = (value == "true" || value == "1" || value == "yes");
+    } else if (key == "shm_time_name") {
+        shm_time_name_ = value;
     } else if (key == "log_file") {
         log_file_ = value;
     } else if (key == "log_level") {
@@ -203,6 +323,16 @@ bool UTCConfig::parse_config_line(const std::string& line) {
         enable_console_logging_ = (value == "true" || value == "1" || value == "yes");
     } else if (key == "enable_syslog") {
         enable_syslog_ = (value == "true" || value == "1" || value == "yes");
+    } else if (key == "log_async") {
+        log_async_ = (value == "true" || value == "1" || value == "yes");
+    } else if (key == "log_queue_size") {
+        log_queue_size_ = std::stoi(value);
+    } else if (key == "log_flush_interval") {
+        log_flush_interval_ = std::stoi(value);
+    } else if (key == "log_flush_size") {
+        log_flush_size_ = std::stoi(value);
+    } else if (key == "log_overflow_policy") {
+        log_overflow_policy_ = value;
     } else if (key == "enable_authentication") {
         enable_authentication_ = (value == "true" || value == "1" || value == "yes");
     } else if (key == "authentication_key") {
@@ -213,6 +343,14 @@ bool UTCConfig::parse_config_line(const std::string& line) {
         allowed_clients_ = parse_list(value);
     } else if (key == "denied_clients") {
         denied_clients_ = parse_list(value);
+    } else if (key == "enable_rate_limiting") {
+        enable_rate_limiting_ = (value == "true" || value == "1" || value == "yes");
+    } else if (key == "rate_limit_requests_per_minute") {
+        rate_limit_requests_per_minute_ = std::stoi(value);
+    } else if (key == "rate_limit_burst_size") {
+        rate_limit_burst_size_ = std::stoi(value);
+    } else if (key == "rate_limit_table_size") {
+        rate_limit_table_size_ = std::stoi(value);
     } else if (key == "worker_threads") {
         worker_threads_ = std::stoi(value);
     } else if (key == "max_packet_size") {
@@ -221,6 +359,38 @@ bool UTCConfig::parse_config_line(const std::string& line) {
         enable_statistics_ = (value == "true" || value == "1" || value == "yes");
     } else if (key == "stats_interval") {
         stats_interval_ = std::stoi(value);
+    } else if (key == "enable_detailed_stats") {
+        enable_detailed_stats_ = (value == "true" || value == "1" || value == "yes");
+    } else if (key == "admin_port") {
+        admin_port_ = std::stoi(value);
+    } else if (key == "admin_address") {
+        admin_address_ = value;
+    } else if (key == "io_backend") {
+        io_backend_ = value;
+    } else if (key == "event_batch_size") {
+        event_batch_size_ = std::stoi(value);
+    } else if (key == "enable_so_reuseport") {
+        enable_so_reuseport_ = (value == "true" || value == "1" || value == "yes");
+    } else if (key == "enable_cpu_affinity") {
+        enable_cpu_affinity_ = (value == "true" || value == "1" || value == "yes");
+    } else if (key == "enable_udp") {
+        enable_udp_ = (value == "true" || value == "1" || value == "yes");
+    } else if (key == "udp_batch_size") {
+        udp_batch_size_ = std::stoi(value);
+    } else if (key == "enable_ntp") {
+        enable_ntp_ = (value == "true" || value == "1" || value == "yes");
+    } else if (key == "ntp_port") {
+        ntp_port_ = std::stoi(value);
+    } else if (key == "enable_kernel_timestamps") {
+        enable_kernel_timestamps_ = (value == "true" || value == "1" || value == "yes");
+    } else if (key == "enable_tx_timestamps") {
+        enable_tx_timestamps_ = (value == "true" || value == "1" || value == "yes");
+    } else if (key == "enable_reply_on_accept") {
+        enable_reply_on_accept_ = (value == "true" || value == "1" || value == "yes");
+    } else if (key == "enable_memory_pooling") {
+        enable_memory_pooling_ = (value == "true" || value == "1" || value == "yes");
+    } else if (key == "memory_pool_size") {
+        memory_pool_size_ = std::stoi(value);
     } else {
         // Unknown configuration option
         return false;
@@ -239,6 +409,27 @@ std::string UTCConfig::trim(const std::string& str) {
     return str.substr(first, (last - first + 1));
 }
 
+const char* UTCConfig::close_strategy_name(CloseStrategy strategy) {
+    switch (strategy) {
+        case CloseStrategy::GRACEFUL: return "graceful";
+        case CloseStrategy::ABORTIVE: return "abortive";
+        default: return "normal";
+    }
+}
+
+bool UTCConfig::parse_close_strategy(const std::string& name, CloseStrategy& strategy) {
+    if (name == "normal") {
+        strategy = CloseStrategy::NORMAL;
+    } else if (name == "graceful") {
+        strategy = CloseStrategy::GRACEFUL;
+    } else if (name == "abortive") {
+        strategy = CloseStrategy::ABORTIVE;
+    } else {
+        return false;
+    }
+    return true;
+}
+
 std::vector<std::string> UTCConfig::parse_list(const std::string& str) {
     std::vector<std::string> result;
 
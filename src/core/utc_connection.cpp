@@ -26,6 +26,8 @@
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <array>
+#include <cerrno>
 #include <cstring>
 
 #ifdef _WIN32
@@ -39,10 +41,10 @@
 
 namespace simple_utcd {
 
-UTCConnection::UTCConnection(int socket_fd, const std::string& client_address,
+UTCConnection::UTCConnection(int socket_fd, const struct sockaddr_storage& peer,
                              UTCConfig* config, Logger* logger)
     : socket_fd_(socket_fd)
-    , client_address_(client_address)
+    , peer_(peer)
     , config_(config)
     , logger_(logger)
     , connected_(true)
@@ -50,9 +52,11 @@ UTCConnection::UTCConnection(int socket_fd, const std::string& client_address,
     , packets_received_(0)
     , bytes_sent_(0)
     , bytes_received_(0)
+    , accept_time_(0)
+    , close_waiting_(false)
 {
     if (logger_) {
-        logger_->info("New connection from {}", client_address_);
+        logger_->debug("New connection from {}", peer_);
     }
 }
 
@@ -60,21 +64,17 @@ UTCConnection::~UTCConnection() {
     close_connection();
 }
 
+std::string UTCConnection::get_client_address() const {
+    return Platform::address_to_string(peer_);
+}
+
 bool UTCConnection::send_packet(const UTCPacket& packet) {
     if (!connected_) {
         return false;
     }
 
-    // Check if client is allowed
-    if (!is_client_allowed()) {
-        if (logger_) {
-            logger_->warn("Connection from {} denied by access control", client_address_);
-        }
-        return false;
-    }
-
-    // Convert packet to bytes
-    std::vector<uint8_t> data = packet.to_bytes();
+    // Encode into a stack buffer; the serving path does not touch the heap
+    std::array<uint8_t, UTCPacket::PACKET_SIZE> data = packet.to_array();
 
     // Send packet data
     if (!send_data(data.data(), data.size())) {
@@ -85,7 +85,7 @@ bool UTCConnection::send_packet(const UTCPacket& packet) {
     bytes_sent_ += data.size();
 
     if (logger_) {
-        logger_->debug("Sent UTC packet to {}: {}", client_address_, packet.to_string());
+        logger_->debug("Sent UTC packet to {}: timestamp={}", peer_, packet.get_timestamp());
     }
 
     return true;
@@ -98,15 +98,15 @@ bool UTCConnection::receive_packet(UTCPacket& packet) {
 
     // UTC protocol typically doesn't receive packets from clients
     // This is mainly for completeness and future extensions
-    std::vector<uint8_t> data(4); // UTC packet is 4 bytes
+    std::array<uint8_t, UTCPacket::PACKET_SIZE> data;
 
     if (!receive_data(data.data(), data.size())) {
         return false;
     }
 
-    if (!packet.from_bytes(data)) {
+    if (!packet.decode_from(data.data(), data.size())) {
         if (logger_) {
-            logger_->warn("Invalid packet received from {}", client_address_);
+            logger_->warn("Invalid packet received from {}", peer_);
         }
         return false;
     }
@@ -115,7 +115,7 @@ bool UTCConnection::receive_packet(UTCPacket& packet) {
     bytes_received_ += data.size();
 
     if (logger_) {
-        logger_->debug("Received packet from {}: {}", client_address_, packet.to_string());
+        logger_->debug("Received packet from {}: timestamp={}", peer_, packet.get_timestamp());
     }
 
     return true;
@@ -126,11 +126,27 @@ void UTCConnection::close_connection() {
         connected_ = false;
 
         if (logger_) {
-            logger_->info("Closing connection from {} (sent: {}, received: {})",
-                         client_address_, packets_sent_, packets_received_);
+            logger_->debug("Closing connection from {} (sent: {}, received: {})",
+                          peer_, packets_sent_, packets_received_);
         }
+    }
 
+    // A failed send or receive already cleared connected_, but the descriptor is still open
+    if (socket_fd_ >= 0) {
         Platform::close_socket(socket_fd_);
+        socket_fd_ = -1;
+    }
+}
+
+bool UTCConnection::peer_closed() {
+    // RFC 868 clients have nothing to say; whatever they send is discarded
+    char buffer[64];
+    while (true) {
+        ssize_t received = recv(socket_fd_, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (received > 0 || (received < 0 && errno == EINTR)) {
+            continue;
+        }
+        return received == 0 || !Platform::would_block();
     }
 }
 
@@ -146,7 +162,7 @@ bool UTCConnection::send_data(const void* data, size_t size) {
         ssize_t sent = send(socket_fd_, buffer + total_sent, size - total_sent, 0);
 
         if (sent < 0) {
-            UTC_ERROR("UTCConnection", "Failed to send data to " + client_address_ + ": " + Platform::get_last_error());
+            UTC_ERROR("UTCConnection", "Failed to send data to " + get_client_address() + ": " + Platform::get_last_error());
             connected_ = false;
             return false;
         }
@@ -170,12 +186,12 @@ bool UTCConnection::receive_data(void* data, size_t size) {
                                size - total_received, 0);
 
         if (received < 0) {
-            UTC_ERROR("UTCConnection", "Failed to receive data from " + client_address_ + ": " + Platform::get_last_error());
+            UTC_ERROR("UTCConnection", "Failed to receive data from " + get_client_address() + ": " + Platform::get_last_error());
             connected_ = false;
             return false;
         } else if (received == 0) {
             // Connection closed by client
-            UTC_INFO("UTCConnection", "Connection closed by client " + client_address_);
+            UTC_INFO("UTCConnection", "Connection closed by client " + get_client_address());
             connected_ = false;
             return false;
         }
@@ -186,54 +202,4 @@ bool UTCConnection::receive_data(void* data, size_t size) {
     return true;
 }
 
-bool UTCConnection::is_client_allowed() const {
-    if (!config_) {
-        return true; // No restrictions if no config
-    }
-
-    // Check if client is in denied list
-    if (is_client_denied()) {
-        return false;
-    }
-
-    // If query restriction is enabled, check allowed list
-    if (config_->is_query_restriction_enabled()) {
-        const auto& allowed_clients = config_->get_allowed_clients();
-        if (allowed_clients.empty()) {
-            return true; // No restrictions if list is empty
-        }
-
-        // Check if client is in allowed list
-        for (const auto& allowed : allowed_clients) {
-            if (client_address_ == allowed) {
-                return true;
-            }
-        }
-
-        return false; // Not in allowed list
-    }
-
-    return true; // No restrictions
-}
-
-bool UTCConnection::is_client_denied() const {
-    if (!config_) {
-        return false; // No restrictions if no config
-    }
-
-    const auto& denied_clients = config_->get_denied_clients();
-    if (denied_clients.empty()) {
-        return false; // No restrictions if list is empty
-    }
-
-    // Check if client is in denied list
-    for (const auto& denied : denied_clients) {
-        if (client_address_ == denied) {
-            return true;
-        }
-    }
-
-    return false; // Not in denied list
-}
-
 } // namespace simple_utcd
@@ -18,6 +18,7 @@
 
 #include "simple_utcd/utc_packet.hpp"
 #include "simple_utcd/error_handler.hpp"
+#include "simple_utcd/time_source.hpp"
 #include <chrono>
 #include <ctime>
 #include <sstream>
@@ -38,18 +39,25 @@ UTCPacket::~UTCPacket() {
 }
 
 bool UTCPacket::from_bytes(const std::vector<uint8_t>& data) {
-    if (data.size() < get_packet_size()) {
-        UTC_ERROR("UTCPacket", "Invalid packet size: expected " + std::to_string(get_packet_size()) +
-                  " bytes, got " + std::to_string(data.size()));
+    return decode_from(data.data(), data.size());
+}
+
+std::vector<uint8_t> UTCPacket::to_bytes() const {
+    std::vector<uint8_t> data(get_packet_size());
+    encode_into(data.data());
+    return data;
+}
+
+bool UTCPacket::decode_from(const uint8_t* data, size_t size) {
+    if (size < PACKET_SIZE) {
+        UTC_ERROR("UTCPacket", "Invalid packet size: expected " + std::to_string(PACKET_SIZE) +
+                  " bytes, got " + std::to_string(size));
         return false;
     }
 
     // UTC protocol uses a simple 32-bit timestamp
     // Network byte order (big-endian)
-    timestamp_ = (static_cast<uint32_t>(data[0]) << 24) |
-                 (static_cast<uint32_t>(data[1]) << 16) |
-                 (static_cast<uint32_t>(data[2]) << 8) |
-                 static_cast<uint32_t>(data[3]);
+    timestamp_ = load_be32(data);
 
     if (!is_valid()) {
         UTC_ERROR("UTCPacket", "Invalid timestamp in packet: " + std::to_string(timestamp_));
@@ -59,22 +67,9 @@ bool UTCPacket::from_bytes(const std::vector<uint8_t>& data) {
     return true;
 }
 
-std::vector<uint8_t> UTCPacket::to_bytes() const {
-    std::vector<uint8_t> data(get_packet_size());
-
-    // Convert timestamp to network byte order (big-endian)
-    data[0] = static_cast<uint8_t>((timestamp_ >> 24) & 0xFF);
-    data[1] = static_cast<uint8_t>((timestamp_ >> 16) & 0xFF);
-    data[2] = static_cast<uint8_t>((timestamp_ >> 8) & 0xFF);
-    data[3] = static_cast<uint8_t>(timestamp_ & 0xFF);
-
-    return data;
-}
-
 uint32_t UTCPacket::get_current_utc_timestamp() {
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    return static_cast<uint32_t>(time_t);
+    // Served from the ticker's cached cell when it is running
+    return TimeSource::instance().now_seconds();
 }
 
 std::string UTCPacket::timestamp_to_string(uint32_t timestamp) {
@@ -117,11 +112,12 @@ uint32_t UTCPacket::string_to_timestamp(const std::string& time_str) {
 }
 
 bool UTCPacket::is_valid() const {
-    return validate_timestamp(timestamp_);
+    // Any timestamp is past the Unix epoch, so only the future bound needs a reference time
+    return validate_timestamp(timestamp_, TimeSource::instance().now_seconds());
 }
 
 size_t UTCPacket::get_packet_size() const {
-    return 4; // 32-bit timestamp in bytes
+    return PACKET_SIZE;
 }
 
 std::string UTCPacket::to_string() const {
@@ -132,31 +128,26 @@ std::string UTCPacket::to_string() const {
     return ss.str();
 }
 
-bool UTCPacket::validate_timestamp(uint32_t timestamp) const {
-    // Basic validation: timestamp should be reasonable
-    // Not before 1970 (Unix epoch) and not too far in the future
-
-    const uint32_t unix_epoch = 0; // January 1, 1970
-    const uint32_t max_reasonable = 4294967295U; // Max uint32_t
-
-    // Check if timestamp is within reasonable bounds
-    if (timestamp < unix_epoch) {
-        return false;
-    }
-
-    // Check if timestamp is not too far in the future (e.g., 100 years from now)
-    auto now = std::chrono::system_clock::now();
-    auto now_time_t = std::chrono::system_clock::to_time_t(now);
-    uint32_t current_timestamp = static_cast<uint32_t>(now_time_t);
-
-    // Allow some tolerance for clock differences (e.g., 1 hour)
-    const uint32_t tolerance = 3600; // 1 hour in seconds
-
-    if (timestamp > (current_timestamp + tolerance)) {
-        return false;
+size_t UTCPacket::validate_many(const uint32_t* timestamps, size_t count, uint32_t now,
+                                bool* results) {
+    // Near the end of the 32-bit range every timestamp is within tolerance
+    const uint32_t limit = now > UINT32_MAX - FUTURE_TOLERANCE ? UINT32_MAX : now + FUTURE_TOLERANCE;
+
+    // 32-bit compares keep both loops vectorizable; the count is widened so it cannot wrap
+    size_t valid = 0;
+    if (results) {
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t ok = timestamps[i] <= limit;
+            results[i] = ok != 0;
+            valid += ok;
+        }
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            valid += timestamps[i] <= limit;
+        }
     }
 
-    return true;
+    return valid;
 }
 
 } // namespace simple_utcd
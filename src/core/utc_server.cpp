@@ -21,14 +21,31 @@
 #include "simple_utcd/utc_packet.hpp"
 #include "simple_utcd/platform.hpp"
 #include "simple_utcd/error_handler.hpp"
+#include "simple_utcd/event_loop.hpp"
+#include "simple_utcd/uring_loop.hpp"
+#include "simple_utcd/udp_batch.hpp"
+#include "simple_utcd/time_source.hpp"
+#include "simple_utcd/access_control.hpp"
+#include "simple_utcd/rate_limiter.hpp"
+#include "simple_utcd/timer_wheel.hpp"
+#include "simple_utcd/time_synchronizer.hpp"
+#include "simple_utcd/ntp_responder.hpp"
+#include "simple_utcd/shm_publisher.hpp"
+#include "simple_utcd/server_stats.hpp"
+#include <algorithm>
+#include <array>
+#include <cerrno>
 #include <mutex>
 #include <thread>
 #include <chrono>
+#include <unordered_map>
+#include <utility>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <signal.h>
+#include <fcntl.h>
 #include <cstring>
 
 #ifdef _WIN32
@@ -39,19 +56,138 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <sys/wait.h>
+#include <netinet/tcp.h>
+#include <poll.h>
 #endif
 
 namespace simple_utcd {
 
+namespace {
+
+// Connection deadlines: 100 ms resolution, one revolution every 51.2 s
+constexpr uint32_t TIMER_TICK_MS = 100;
+constexpr size_t TIMER_SLOTS = 512;
+
+// An edge-triggered listener that hit an accept error is polled again after this long
+constexpr uint32_t ACCEPT_RETRY_MS = 100;
+
+// How long an io_uring worker waits at shutdown for its queued writes and closes
+constexpr uint64_t URING_DRAIN_MS = 2000;
+
+// Counter stripes; more than the serving threads we ever start
+constexpr size_t STATS_SLOTS = 64;
+
+// io_uring completion kinds, in the low bits of user_data; a write carries its accept time above them
+constexpr uint64_t URING_ACCEPT = 0;
+constexpr uint64_t URING_WRITE = 1;
+constexpr uint64_t URING_CLOSE = 2;
+constexpr uint64_t URING_KIND_MASK = 3;
+constexpr int URING_KIND_BITS = 2;
+
+// Policy reader slots: the acceptor, the udp thread, then one per worker
+constexpr size_t ACCEPTOR_READER = 0;
+constexpr size_t UDP_READER = 1;
+constexpr size_t WORKER_READERS = 2;
+
+int64_t wall_ns() {
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
+} // namespace
+
+struct UTCServer::Worker {
+    int id = 0;
+    int listen_fd = -1;
+    bool owns_listener = false;  // true for SO_REUSEPORT shards
+    int udp_fd = -1;
+    bool owns_udp = false;
+    size_t max_connections = 0;  // this worker's share of max_connections
+    std::unique_ptr<EventLoop> loop;
+    std::unique_ptr<UringLoop> ring;  // instead of loop on the io_uring backend
+    std::unique_ptr<UDPBatch> udp_batch;
+    int ntp_fd = -1;
+    bool owns_ntp = false;
+    std::unique_ptr<UDPBatch> ntp_batch;
+    std::unique_ptr<TimerWheel> timers;
+    TimerWheel::Timer accept_retry;  // armed while accept errors keep the listener from draining
+    int reserve_fd = -1;             // given up to shed one connection when descriptors run out
+    std::unique_ptr<ConnectionPool> pool;  // declared first so it outlives the connections
+    std::unordered_map<int, ConnectionPtr> connections;
+    std::thread thread;
+    char listener_tag = 0;  // its address marks listener events in the loop
+    char udp_tag = 0;       // likewise for the datagram socket
+    char ntp_tag = 0;       // and the NTP socket
+
+    // Per-shard counters, read by other threads
+    std::atomic<uint64_t> accepted{0};
+    std::atomic<uint64_t> rejected{0};
+    std::atomic<uint64_t> timed_out{0};
+
+    LatencySet latency;  // written only by this worker
+
+    // Pre-encoded replies, one slot per second parity, so an in-flight io_uring write
+    // never sees its bytes change under it; registered as the ring's fixed buffer
+    alignas(8) uint8_t replies[8] = {};
+    uint32_t reply_seconds[2] = {0, 0};
+    size_t in_flight = 0;
+
+    // A slot is only re-encoded when its second comes round
+    const uint8_t* reply_for(uint32_t seconds) {
+        size_t slot = seconds & 1;
+        uint8_t* reply = replies + slot * UTCPacket::PACKET_SIZE;
+        if (reply_seconds[slot] != seconds) {
+            UTCPacket::store_be32(seconds, reply);
+            reply_seconds[slot] = seconds;
+        }
+        return reply;
+    }
+
+    ~Worker() {
+        if (owns_listener && listen_fd >= 0) {
+            Platform::close_socket(listen_fd);
+        }
+        if (owns_udp && udp_fd >= 0) {
+            Platform::close_socket(udp_fd);
+        }
+        if (owns_ntp && ntp_fd >= 0) {
+            Platform::close_socket(ntp_fd);
+        }
+        if (reserve_fd >= 0) {
+            close(reserve_fd);
+        }
+    }
+};
+
+// Everything reload() can change, compiled once per load and never modified after publishing
+struct UTCServer::Policy {
+    std::shared_ptr<const AccessControl> access_control;
+    std::shared_ptr<RateLimiter> rate_limiter;  // null when rate limiting is off
+    size_t rate_limit_table_size = 0;
+    int rate_limit_requests_per_minute = 0;
+    int rate_limit_burst_size = 0;
+    int connection_timeout = 0;
+    uint64_t generation = 0;
+
+    bool filtered() const { return access_control->is_filtering() || rate_limiter; }
+};
+
 UTCServer::UTCServer(UTCConfig* config, Logger* logger)
     : config_(config)
     , logger_(logger)
     , running_(false)
-    , active_connections_(0)
-    , total_connections_(0)
-    , packets_sent_(0)
-    , packets_received_(0)
+    , use_event_loop_(false)
+    , use_io_uring_(false)
+    , limiter_shards_(0)
+    , stats_(std::make_unique<ServerStats>(STATS_SLOTS))
+    , detailed_stats_(false)
+    , kernel_timestamps_(false)
+    , tx_timestamps_(false)
+    , close_strategy_(CloseStrategy::NORMAL)
+    , reply_on_accept_(false)
     , server_socket_(-1)
+    , udp_socket_(-1)
+    , ntp_socket_(-1)
 {
     if (logger_) {
         logger_->info("UTC Server initialized");
@@ -75,30 +211,265 @@ bool UTCServer::start() {
         return false;
     }
 
+    // Pick the serving backend
+    const std::string& backend = config_->get_io_backend();
+    use_event_loop_ = false;
+    use_io_uring_ = false;
+    if (backend == "io_uring") {
+        use_io_uring_ = UringLoop::is_supported();
+        if (!use_io_uring_ && logger_) {
+            logger_->warn("io_uring backend not available (built without liburing or kernel older than 5.19), "
+                          "using epoll");
+        }
+    }
+    if (backend == "epoll" || (backend == "io_uring" && !use_io_uring_)) {
+        use_event_loop_ = EventLoop::is_supported();
+        if (!use_event_loop_ && logger_) {
+            logger_->warn("epoll backend not supported on this platform, using threads");
+        }
+    } else if (backend != "threads" && backend != "io_uring") {
+        if (logger_) {
+            logger_->warn("Unknown io_backend '{}', using threads", backend);
+        }
+    }
+
+    int num_threads = std::max(1, config_->get_worker_threads());
+
+    // Only the event loop can park a connection on its timer wheel while waiting for the peer.
+    // io_uring closes inside the linked submission, and on the threads backend the wait would
+    // hold a worker for close_wait_timeout per connection, which any client could exploit
+    close_strategy_ = config_->get_close_strategy();
+    if (!use_event_loop_ && close_strategy_ == CloseStrategy::GRACEFUL) {
+        close_strategy_ = CloseStrategy::NORMAL;
+        if (logger_) {
+            logger_->warn("close_strategy graceful is not supported by the {} backend, using normal",
+                          use_io_uring_ ? "io_uring" : "threads");
+        }
+    }
+
+    // io_uring always replies from the accept completion
+    reply_on_accept_ = config_->is_reply_on_accept_enabled() && !use_io_uring_;
+
+    // Transmit stamps only feed the residence histogram, and need the receive stamp to pair with
+    kernel_timestamps_ = config_->is_kernel_timestamps_enabled();
+    tx_timestamps_ = kernel_timestamps_ && config_->is_tx_timestamps_enabled() &&
+                     config_->is_detailed_stats_enabled();
+
+    // Sharded mode gives every event loop or io_uring worker its own SO_REUSEPORT listener
+    bool sharded = (use_event_loop_ || use_io_uring_) && config_->is_so_reuseport_enabled();
+#ifndef SO_REUSEPORT
+    if (sharded) {
+        if (logger_) {
+            logger_->warn("SO_REUSEPORT not supported on this platform, using a shared listener");
+        }
+        sharded = false;
+    }
+#endif
+
     // Create server socket
-    if (!create_server_socket()) {
+    if (!sharded && !create_server_socket()) {
         return false;
     }
 
+    // io_uring workers only take TCP; datagrams stay on one shared socket and the udp thread
+    bool udp_sharded = sharded && use_event_loop_;
+
+    // The RFC 868 datagram responder sits next to the TCP listener
+    bool udp = config_->is_udp_enabled();
+    if (udp && !udp_sharded) {
+        udp_socket_ = open_udp_socket(config_->get_listen_port(), false, false);
+        if (udp_socket_ < 0) {
+            close_server_socket();
+            return false;
+        }
+    }
+
+    // So is the NTP responder, on its own port
+    bool ntp = config_->is_ntp_enabled();
+    if (ntp && !udp_sharded) {
+        ntp_socket_ = open_udp_socket(config_->get_ntp_port(), false, tx_timestamps_);
+        if (ntp_socket_ < 0) {
+            close_server_socket();
+            return false;
+        }
+    }
+
+    if (use_event_loop_) {
+        if (!sharded && !Platform::set_nonblocking(server_socket_)) {
+            UTC_ERROR("UTCServer", "Failed to make server socket non-blocking: " + Platform::get_last_error());
+            close_server_socket();
+            return false;
+        }
+
+        for (int i = 0; i < num_threads; ++i) {
+            auto worker = std::make_unique<Worker>();
+            worker->id = i;
+            worker->max_connections = static_cast<size_t>(
+                (std::max(1, config_->get_max_connections()) + num_threads - 1) / num_threads);
+            worker->loop = std::make_unique<EventLoop>(config_->get_event_batch_size());
+            worker->timers = std::make_unique<TimerWheel>(TIMER_SLOTS, TIMER_TICK_MS);
+            worker->accept_retry.data = &worker->listener_tag;
+            worker->reserve_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+            if (config_->is_memory_pooling_enabled()) {
+                worker->pool = std::make_unique<ConnectionPool>(pool_capacity(num_threads), false);
+            }
+            if (sharded) {
+                worker->listen_fd = open_listener(true);
+                worker->owns_listener = true;
+            } else {
+                worker->listen_fd = server_socket_;
+            }
+
+            // A shared listener is watched by every loop; EPOLLEXCLUSIVE wakes only one
+            bool ready = worker->listen_fd >= 0 && worker->loop->is_valid() &&
+                worker->loop->add(worker->listen_fd, EventLoop::EVENT_READABLE, &worker->listener_tag, !sharded);
+
+            if (ready && udp) {
+                if (sharded) {
+                    worker->udp_fd = open_udp_socket(config_->get_listen_port(), true, false);
+                    worker->owns_udp = true;
+                } else {
+                    worker->udp_fd = udp_socket_;
+                }
+                worker->udp_batch = std::make_unique<UDPBatch>(config_->get_udp_batch_size(),
+                                                               config_->get_max_packet_size(), kernel_timestamps_);
+                ready = worker->udp_fd >= 0 &&
+                    worker->loop->add(worker->udp_fd, EventLoop::EVENT_READABLE, &worker->udp_tag, !sharded);
+            }
+
+            if (ready && ntp) {
+                if (sharded) {
+                    worker->ntp_fd = open_udp_socket(config_->get_ntp_port(), true, tx_timestamps_);
+                    worker->owns_ntp = true;
+                } else {
+                    worker->ntp_fd = ntp_socket_;
+                }
+                worker->ntp_batch = std::make_unique<UDPBatch>(config_->get_udp_batch_size(),
+                                                               config_->get_max_packet_size(), kernel_timestamps_);
+                ready = worker->ntp_fd >= 0 &&
+                    worker->loop->add(worker->ntp_fd, EventLoop::EVENT_READABLE, &worker->ntp_tag, !sharded);
+            }
+
+            if (!ready) {
+                UTC_ERROR("UTCServer", "Failed to set up event loop for worker " + std::to_string(i));
+                workers_.clear();
+                close_server_socket();
+                return false;
+            }
+            workers_.push_back(std::move(worker));
+        }
+    } else if (use_io_uring_) {
+        for (int i = 0; i < num_threads; ++i) {
+            auto worker = std::make_unique<Worker>();
+            worker->id = i;
+            worker->max_connections = static_cast<size_t>(
+                (std::max(1, config_->get_max_connections()) + num_threads - 1) / num_threads);
+            worker->ring = std::make_unique<UringLoop>(static_cast<unsigned>(config_->get_event_batch_size()));
+            if (sharded) {
+                worker->listen_fd = open_listener(true);
+                worker->owns_listener = true;
+            } else {
+                worker->listen_fd = server_socket_;
+            }
+
+            // Every ring accepts on the shared listener; the kernel hands each connection to one
+            bool ready = worker->listen_fd >= 0 && worker->ring->is_valid() &&
+                worker->ring->register_buffer(worker->replies, sizeof(worker->replies)) &&
+                worker->ring->accept_multishot(worker->listen_fd, URING_ACCEPT);
+
+            if (!ready) {
+                UTC_ERROR("UTCServer", "Failed to set up io_uring for worker " + std::to_string(i));
+                workers_.clear();
+                close_server_socket();
+                return false;
+            }
+            workers_.push_back(std::move(worker));
+        }
+    }
+
+    // Several limiter shards per worker keep lock contention between workers rare
+    limiter_shards_ = static_cast<size_t>(num_threads) * 4;
+    policy_ = std::make_unique<SnapshotCell<Policy>>(make_policy(*config_, nullptr),
+                                                     WORKER_READERS + static_cast<size_t>(num_threads));
+
+    detailed_stats_ = config_->is_detailed_stats_enabled();
+
     running_ = true;
 
+    // Replies read the cached second instead of the clock
+    TimeSource::instance().start();
+
+    // Upstream corrections land in the same cell, off the serving threads
+    if (config_->is_upstream_sync_enabled()) {
+        synchronizer_ = std::make_unique<TimeSynchronizer>(config_, logger_);
+        if (!synchronizer_->start()) {
+            synchronizer_.reset();
+        }
+    }
+    if (ntp) {
+        ntp_responder_ = std::make_unique<NTPResponder>(config_, synchronizer_.get());
+    }
+
+    // Local readers get the same time without a connection; failing to publish never stops serving
+    if (config_->is_shm_time_enabled()) {
+        shm_publisher_ = std::make_unique<ShmPublisher>(config_->get_shm_time_name(), synchronizer_.get(), logger_);
+        if (!shm_publisher_->start()) {
+            shm_publisher_.reset();
+        }
+    }
+
     if (logger_) {
         logger_->info("Starting UTC Server on {}:{}",
                      config_->get_listen_address(), config_->get_listen_port());
     }
 
-    // Start worker threads
-    int num_threads = config_->get_worker_threads();
-    for (int i = 0; i < num_threads; ++i) {
-        worker_threads_.emplace_back(&UTCServer::worker_thread_main, this);
+    if (use_event_loop_) {
+        for (auto& worker : workers_) {
+            worker->thread = std::thread(&UTCServer::event_loop_main, this, worker.get());
+        }
+    } else if (use_io_uring_) {
+        for (auto& worker : workers_) {
+            worker->thread = std::thread(&UTCServer::uring_main, this, worker.get());
+        }
+
+        thread_latency_.clear();
+        if (udp || ntp) {
+            thread_latency_.push_back(std::make_unique<LatencySet>());
+            udp_thread_ = std::thread(&UTCServer::udp_thread_main, this, thread_latency_.back().get());
+        }
+    } else {
+        // The acceptor allocates and the workers free, so this pool is locked
+        if (config_->is_memory_pooling_enabled()) {
+            connection_pool_ = std::make_unique<ConnectionPool>(pool_capacity(1), true);
+        }
+        connection_queue_ = std::make_unique<MPMCQueue<ConnectionPtr>>(
+            static_cast<size_t>(std::max(1, config_->get_max_connections())));
+
+        // Start worker threads
+        thread_latency_.clear();
+        for (int i = 0; i < num_threads; ++i) {
+            thread_latency_.push_back(std::make_unique<LatencySet>());
+            worker_threads_.emplace_back(&UTCServer::worker_thread_main, this, thread_latency_.back().get());
+        }
+
+        // Start accepting connections; the acceptor records latency when it replies itself
+        thread_latency_.push_back(std::make_unique<LatencySet>());
+        accept_thread_ = std::thread(&UTCServer::accept_connections, this, thread_latency_.back().get());
+
+        if (udp || ntp) {
+            thread_latency_.push_back(std::make_unique<LatencySet>());
+            udp_thread_ = std::thread(&UTCServer::udp_thread_main, this, thread_latency_.back().get());
+        }
     }
 
-    // Start accepting connections
-    std::thread accept_thread(&UTCServer::accept_connections, this);
-    accept_thread.detach();
+    if (config_->is_statistics_enabled() && config_->get_stats_interval() > 0) {
+        stats_thread_ = std::thread(&UTCServer::stats_thread_main, this);
+    }
 
     if (logger_) {
-        logger_->info("UTC Server started successfully with {} worker threads", num_threads);
+        logger_->info("UTC Server started successfully with {} worker threads ({}{})",
+                     num_threads, use_io_uring_ ? "io_uring" : use_event_loop_ ? "epoll" : "threads",
+                     sharded ? ", SO_REUSEPORT shards" : "");
     }
 
     return true;
@@ -113,23 +484,52 @@ void UTCServer::stop() {
         logger_->info("Stopping UTC Server...");
     }
 
-    running_ = false;
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        running_ = false;
+    }
+    stats_cv_.notify_all();
+    if (stats_thread_.joinable()) {
+        stats_thread_.join();
+    }
+
+    // Event loop workers own their connections and clean up on exit; io_uring
+    // workers notice within their bounded wait
+    for (auto& worker : workers_) {
+        if (worker->loop) {
+            worker->loop->wakeup();
+        }
+    }
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+        if (logger_) {
+            logger_->info("Worker {} accepted {} connections, rejected {}, timed out {}",
+                         worker->id, worker->accepted.load(), worker->rejected.load(),
+                         worker->timed_out.load());
+        }
+    }
+    workers_.clear();
+
+    // Unblock the acceptor before closing the listener under it
+    if (server_socket_ >= 0) {
+        shutdown(server_socket_, SHUT_RDWR);
+    }
+    if (accept_thread_.joinable()) {
+        accept_thread_.join();
+    }
+    if (udp_thread_.joinable()) {
+        udp_thread_.join();
+    }
 
     // Close server socket
     close_server_socket();
 
-    // Close all connections
-    {
-        std::lock_guard<std::mutex> lock(connections_mutex_);
-        for (auto& connection : connections_) {
-            if (connection) {
-                connection->close_connection();
-            }
-        }
-        connections_.clear();
+    // Wake parked workers and wait for them to finish
+    if (connection_queue_) {
+        connection_queue_->notify_all();
     }
-
-    // Wait for worker threads to finish
     for (auto& thread : worker_threads_) {
         if (thread.joinable()) {
             thread.join();
@@ -137,145 +537,1162 @@ void UTCServer::stop() {
     }
     worker_threads_.clear();
 
+    // Close connections that were accepted but never served
+    if (connection_queue_) {
+        ConnectionPtr connection;
+        while (connection_queue_->try_pop(connection)) {
+            connection->close_connection();
+            connection.reset();
+            stats_->add(Counter::CONNECTIONS_CLOSED);
+        }
+        connection_queue_.reset();
+    }
+    connection_pool_.reset();
+
+    ntp_responder_.reset();
+    if (shm_publisher_) {
+        shm_publisher_->stop();
+        shm_publisher_.reset();
+    }
+    if (synchronizer_) {
+        synchronizer_->stop();
+        synchronizer_.reset();
+    }
+    TimeSource::instance().stop();
+
+    if (policy_ && logger_) {
+        std::lock_guard<std::mutex> lock(policy_mutex_);
+        const Policy* policy = policy_->current();
+        if (policy->rate_limiter) {
+            logger_->info("Rate limiter dropped {} requests ({} table evictions)",
+                         policy->rate_limiter->get_dropped(), policy->rate_limiter->get_evictions());
+        }
+    }
+
     if (logger_) {
         logger_->info("UTC Server stopped");
     }
 }
 
-void UTCServer::accept_connections() {
+bool UTCServer::reload(const UTCConfig& config) {
+    std::unique_lock<std::mutex> lock(policy_mutex_);
+    if (!running_ || !policy_) {
+        return false;
+    }
+
+    // config_ stays the configuration the sockets and threads were built from
+    const std::pair<const char*, bool> restart_only[] = {
+        {"listen_address", config.get_listen_address() != config_->get_listen_address()},
+        {"listen_port", config.get_listen_port() != config_->get_listen_port()},
+        {"enable_ipv6", config.is_ipv6_enabled() != config_->is_ipv6_enabled()},
+        {"max_connections", config.get_max_connections() != config_->get_max_connections()},
+        {"close_strategy", config.get_close_strategy() != config_->get_close_strategy()},
+        {"close_wait_timeout", config.get_close_wait_timeout() != config_->get_close_wait_timeout()},
+        {"listen_backlog", config.get_listen_backlog() != config_->get_listen_backlog()},
+        {"socket_buffer_size", config.get_socket_buffer_size() != config_->get_socket_buffer_size()},
+        {"enable_tcp_fastopen", config.is_tcp_fastopen_enabled() != config_->is_tcp_fastopen_enabled()},
+        {"worker_threads", config.get_worker_threads() != config_->get_worker_threads()},
+        {"io_backend", config.get_io_backend() != config_->get_io_backend()},
+        {"enable_so_reuseport", config.is_so_reuseport_enabled() != config_->is_so_reuseport_enabled()},
+        {"enable_udp", config.is_udp_enabled() != config_->is_udp_enabled()},
+        {"enable_ntp", config.is_ntp_enabled() != config_->is_ntp_enabled()},
+        {"ntp_port", config.get_ntp_port() != config_->get_ntp_port()},
+        {"enable_reply_on_accept", config.is_reply_on_accept_enabled() != config_->is_reply_on_accept_enabled()},
+        {"enable_detailed_stats", config.is_detailed_stats_enabled() != config_->is_detailed_stats_enabled()},
+        {"enable_upstream_sync", config.is_upstream_sync_enabled() != config_->is_upstream_sync_enabled()},
+        {"enable_shm_time", config.is_shm_time_enabled() != config_->is_shm_time_enabled()},
+        {"shm_time_name", config.get_shm_time_name() != config_->get_shm_time_name()},
+        {"upstream_servers", config.get_upstream_servers() != config_->get_upstream_servers()},
+        {"sync_interval", config.get_sync_interval() != config_->get_sync_interval()},
+        {"timeout", config.get_timeout() != config_->get_timeout()},
+        {"max_step", config.get_max_step() != config_->get_max_step()},
+        {"stratum", config.get_stratum() != config_->get_stratum()},
+        {"reference_id", config.get_reference_id() != config_->get_reference_id()},
+        {"reference_clock", config.get_reference_clock() != config_->get_reference_clock()},
+        {"enable_kernel_timestamps", config.is_kernel_timestamps_enabled() != config_->is_kernel_timestamps_enabled()},
+        {"enable_tx_timestamps", config.is_tx_timestamps_enabled() != config_->is_tx_timestamps_enabled()},
+        {"udp_batch_size", config.get_udp_batch_size() != config_->get_udp_batch_size()},
+        {"event_batch_size", config.get_event_batch_size() != config_->get_event_batch_size()},
+        {"enable_memory_pooling", config.is_memory_pooling_enabled() != config_->is_memory_pooling_enabled()},
+        {"memory_pool_size", config.get_memory_pool_size() != config_->get_memory_pool_size()},
+        {"enable_cpu_affinity", config.is_cpu_affinity_enabled() != config_->is_cpu_affinity_enabled()},
+        {"admin_port", config.get_admin_port() != config_->get_admin_port()},
+        {"admin_address", config.get_admin_address() != config_->get_admin_address()},
+    };
+    if (logger_) {
+        for (const auto& key : restart_only) {
+            if (key.second) {
+                logger_->warn("Configuration key {} changed; it takes effect on restart", key.first);
+            }
+        }
+    }
+
+    policy_->publish(make_policy(config, policy_->current()));
+    const Policy* policy = policy_->current();
+    if (logger_) {
+        logger_->info("Configuration reloaded (generation {}): {} access rules, rate limiting {}",
+                     policy->generation, policy->access_control->rule_count(),
+                     policy->rate_limiter ? "on" : "off");
+    }
+
+    // Readers pin for one batch at most, so the old snapshot is normally free at once. The lock
+    // is dropped between attempts so /metrics scrapes are not held up; whatever is still pinned
+    // afterwards goes on the next publish
+    size_t pending = policy_->reclaim();
+    for (int i = 0; pending > 0 && i < 100; ++i) {
+        lock.unlock();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        lock.lock();
+        pending = policy_->reclaim();
+    }
+
+    if (pending > 0 && logger_) {
+        logger_->debug("{} retired policy snapshots still pinned", pending);
+    }
+    return true;
+}
+
+void UTCServer::accept_connections(LatencySet* latency) {
+    LatencySet* recorder = detailed_stats_ ? latency : nullptr;
+    alignas(4) uint8_t reply[UTCPacket::PACKET_SIZE] = {};
+    uint32_t reply_seconds = 0;
+
     while (running_) {
-        std::string client_address;
-        int client_fd = Platform::accept_connection(server_socket_, client_address);
+        struct sockaddr_storage client_addr;
+        int client_fd = Platform::accept_connection(server_socket_, &client_addr);
 
         if (client_fd < 0) {
-            if (running_) {
-                UTC_ERROR("UTCServer", "Failed to accept connection: " + Platform::get_last_error());
+            if (!running_) {
+                break;
             }
+            stats_->add(Counter::ACCEPT_FAILED);
+            UTC_ERROR("UTCServer", "Failed to accept connection: " + Platform::get_last_error());
             continue;
         }
 
-        // Check connection limit
-        if (active_connections_ >= config_->get_max_connections()) {
-            if (logger_) {
-                logger_->warn("Connection limit reached, rejecting connection from {}", client_address);
-            }
+        // Pinned until the hand-off; never across the blocking accept
+        auto policy = policy_->pin(ACCEPTOR_READER);
+
+        // Filter before any per-connection state exists
+        if (!policy->access_control->is_allowed(client_addr)) {
             Platform::close_socket(client_fd);
+            stats_->add(Counter::CONNECTIONS_DENIED);
             continue;
         }
+        if (policy->rate_limiter && !policy->rate_limiter->allow(client_addr)) {
+            Platform::close_socket(client_fd);
+            stats_->add(Counter::CONNECTIONS_REJECTED);
+            continue;
+        }
+
+        // Fast path: the reply goes out before the worker hand-off is even considered
+        if (reply_on_accept_) {
+            uint32_t seconds = get_utc_timestamp();
+            if (reply_seconds != seconds) {
+                UTCPacket::store_be32(seconds, reply);
+                reply_seconds = seconds;
+            }
+            uint64_t accepted = recorder ? LatencyHistogram::now_ns() : 0;
+            AcceptReply result = reply_on_accept(client_fd, reply, accepted, recorder);
+            if (result != AcceptReply::DEFERRED) {
+                Platform::close_socket(client_fd);
+                stats_->add(Counter::CONNECTIONS_ACCEPTED);
+                stats_->add(Counter::CONNECTIONS_CLOSED);
+                continue;
+            }
+        }
+
+        // Blocking sockets: bound the send instead of arming a timer
+        int timeout_ms = policy->connection_timeout;
+        if (timeout_ms > 0) {
+            struct timeval send_timeout;
+            send_timeout.tv_sec = timeout_ms / 1000;
+            send_timeout.tv_usec = (timeout_ms % 1000) * 1000;
+            Platform::set_socket_option(client_fd, SOL_SOCKET, SO_SNDTIMEO, &send_timeout, sizeof(send_timeout));
+        }
 
         // Create connection object
-        auto connection = std::make_unique<UTCConnection>(client_fd, client_address, config_, logger_);
+        ConnectionPtr connection = make_connection(connection_pool_.get(), client_fd, client_addr);
+        if (detailed_stats_) {
+            connection->set_accept_time(LatencyHistogram::now_ns());
+        }
 
-        // Add to connections list
-        {
-            std::lock_guard<std::mutex> lock(connections_mutex_);
-            connections_.push_back(std::move(connection));
+        // Hand off to the worker pool. The queue holds max_connections entries, which
+        // is the connection limit here; on failure the connection is closed by its owner
+        if (!connection_queue_->try_push(connection)) {
+            if (logger_) {
+                logger_->warn("Connection limit reached, rejecting connection from {}", client_addr);
+            }
+            stats_->add(Counter::CONNECTIONS_REJECTED);
+            continue;
         }
 
-        active_connections_++;
-        total_connections_++;
+        stats_->add(Counter::CONNECTIONS_ACCEPTED);
 
         if (logger_) {
-            logger_->debug("Accepted connection from {} (active: {})",
-                          client_address, active_connections_);
+            logger_->debug("Accepted connection from {}", client_addr);
         }
     }
 }
 
-void UTCServer::handle_connection(std::unique_ptr<UTCConnection> connection) {
+void UTCServer::stats_thread_main() {
+    auto interval = std::chrono::seconds(config_->get_stats_interval());
+    auto last_time = std::chrono::steady_clock::now();
+    StatsSnapshot last = stats_->snapshot();
+
+    std::unique_lock<std::mutex> lock(stats_mutex_);
+    while (running_) {
+        if (stats_cv_.wait_for(lock, interval, [this] { return !running_; })) {
+            break;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        StatsSnapshot current = stats_->snapshot();
+        log_stats(current, last, std::chrono::duration<double>(now - last_time).count());
+        last = current;
+        last_time = now;
+    }
+}
+
+LatencySummary UTCServer::get_latency(LatencyMetric metric) const {
+    // Merge into a private histogram; the writers are never paused
+    LatencyHistogram merged;
+    size_t index = static_cast<size_t>(metric);
+    for (const auto& worker : workers_) {
+        merged.merge_from(worker->latency[index]);
+    }
+    for (const auto& latency : thread_latency_) {
+        merged.merge_from((*latency)[index]);
+    }
+    return merged.summary();
+}
+
+std::vector<LatencySummary> UTCServer::get_worker_latency(LatencyMetric metric) const {
+    std::vector<LatencySummary> summaries;
+    size_t index = static_cast<size_t>(metric);
+    for (const auto& worker : workers_) {
+        summaries.push_back(worker->latency[index].summary());
+    }
+    for (const auto& latency : thread_latency_) {
+        summaries.push_back((*latency)[index].summary());
+    }
+    return summaries;
+}
+
+bool UTCServer::is_listener_healthy() const {
+    if (!running_) {
+        return false;
+    }
+
+    auto accepting = [](int fd) {
+        int value = 0;
+        socklen_t length = sizeof(value);
+        return fd >= 0 && getsockopt(fd, SOL_SOCKET, SO_ACCEPTCONN, &value, &length) == 0 && value != 0;
+    };
+
+    if (workers_.empty()) {
+        return accepting(server_socket_);
+    }
+    for (const auto& worker : workers_) {
+        if (!accepting(worker->listen_fd)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void UTCServer::log_stats(const StatsSnapshot& current, const StatsSnapshot& previous, double seconds) {
+    if (!logger_) {
+        return;
+    }
+
+    double rate = seconds > 0 ? (current.packets_sent - previous.packets_sent) / seconds : 0.0;
+    logger_->info("Stats: connections total={} active={} denied={} rejected={} timed_out={}, "
+                  "packets sent={} received={}, {} replies/s",
+                  current.total_connections, current.active_connections,
+                  current.connections_denied, current.connections_rejected, current.connections_timed_out,
+                  current.packets_sent, current.packets_received, rate);
+
+    // Host-wide, but on a time server it is this daemon's closes that fill TIME_WAIT
+    TcpSocketStats tcp;
+    if (Platform::read_tcp_socket_stats(tcp)) {
+        logger_->info("TCP sockets: time_wait={} orphaned={} memory={} bytes",
+                      tcp.time_wait, tcp.orphaned, tcp.memory_bytes);
+    }
+
+    if (!detailed_stats_) {
+        return;
+    }
+
+    static const char* const names[] = {"accept_to_send", "send", "queue_wait", "ntp_residence"};
+    for (size_t i = 0; i < static_cast<size_t>(LatencyMetric::COUNT); ++i) {
+        LatencySummary latency = get_latency(static_cast<LatencyMetric>(i));
+        logger_->info("Latency {} (us): count={} p50={} p99={} p999={} max={}",
+                      names[i], latency.count, latency.p50 / 1000.0, latency.p99 / 1000.0,
+                      latency.p999 / 1000.0, latency.max / 1000.0);
+    }
+}
+
+std::unique_ptr<const UTCServer::Policy> UTCServer::make_policy(const UTCConfig& config,
+                                                                const Policy* previous) const {
+    auto policy = std::make_unique<Policy>();
+
+    // Compiled once at config load; the serving paths only look it up
+    policy->access_control = config.get_access_control();
+    if (logger_) {
+        for (const auto& rule : policy->access_control->invalid_rules()) {
+            logger_->warn("Ignoring invalid access control entry '{}'", rule);
+        }
+        // An allow list alone reads like a restriction but lets everyone in
+        if (!config.get_allowed_clients().empty() && !config.is_query_restriction_enabled()) {
+            logger_->warn("allowed_clients is set but restrict_queries is off; every client is allowed");
+        }
+    }
+
+    // An unchanged limiter is carried over so a reload does not hand every client a fresh bucket
+    if (config.is_rate_limiting_enabled()) {
+        policy->rate_limit_table_size = static_cast<size_t>(std::max(1, config.get_rate_limit_table_size()));
+        policy->rate_limit_requests_per_minute = config.get_rate_limit_requests_per_minute();
+        policy->rate_limit_burst_size = config.get_rate_limit_burst_size();
+        if (previous && previous->rate_limiter &&
+            previous->rate_limit_table_size == policy->rate_limit_table_size &&
+            previous->rate_limit_requests_per_minute == policy->rate_limit_requests_per_minute &&
+            previous->rate_limit_burst_size == policy->rate_limit_burst_size) {
+            policy->rate_limiter = previous->rate_limiter;
+        } else {
+            policy->rate_limiter = std::make_shared<RateLimiter>(
+                policy->rate_limit_table_size, limiter_shards_,
+                policy->rate_limit_requests_per_minute, policy->rate_limit_burst_size);
+        }
+    }
+
+    policy->connection_timeout = config.get_connection_timeout();
+    policy->generation = previous ? previous->generation + 1 : 1;
+    return policy;
+}
+
+size_t UTCServer::pool_capacity(int pools) const {
+    // memory_pool_size is a byte budget shared by all pools
+    size_t bytes = static_cast<size_t>(std::max(0, config_->get_memory_pool_size()));
+    return std::max<size_t>(1, bytes / sizeof(UTCConnection) / static_cast<size_t>(std::max(1, pools)));
+}
+
+ConnectionPtr UTCServer::make_connection(ConnectionPool* pool, int client_fd, const struct sockaddr_storage& peer) {
+    if (pool) {
+        return pool->acquire(client_fd, peer, config_, logger_);
+    }
+    return ConnectionPool::make_unpooled(client_fd, peer, config_, logger_);
+}
+
+void UTCServer::handle_connection(ConnectionPtr connection, LatencySet* latency) {
     if (!connection) {
         return;
     }
 
+    if (latency) {
+        uint64_t waited = LatencyHistogram::now_ns() - connection->get_accept_time();
+        (*latency)[static_cast<size_t>(LatencyMetric::QUEUE_WAIT)].record(waited);
+    }
+
     // Send current UTC time to client
+    send_time(connection.get(), latency);
+
+    // Close connection after sending (UTC protocol is typically one-shot)
+    connection->close_connection();
+
+    stats_->add(Counter::CONNECTIONS_CLOSED);
+}
+
+void UTCServer::worker_thread_main(LatencySet* latency) {
+    LatencySet* recorder = detailed_stats_ ? latency : nullptr;
+
+    while (running_) {
+        ConnectionPtr connection;
+
+        // Park until the acceptor hands over a connection; the timeout only bounds shutdown latency
+        if (connection_queue_->pop_wait(connection, std::chrono::milliseconds(100))) {
+            handle_connection(std::move(connection), recorder);
+        }
+    }
+}
+
+std::vector<uint64_t> UTCServer::get_shard_connection_counts() const {
+    std::vector<uint64_t> counts;
+    counts.reserve(workers_.size());
+    for (const auto& worker : workers_) {
+        counts.push_back(worker->accepted.load(std::memory_order_relaxed));
+    }
+    return counts;
+}
+
+std::vector<uint64_t> UTCServer::get_rate_limited_counts() const {
+    std::lock_guard<std::mutex> lock(policy_mutex_);
+    const Policy* policy = policy_ ? policy_->current() : nullptr;
+    if (!policy || !policy->rate_limiter) {
+        return {};
+    }
+    return policy->rate_limiter->get_shard_drop_counts();
+}
+
+void UTCServer::event_loop_main(Worker* worker) {
+    EventLoop& loop = *worker->loop;
+
+    if (config_->is_cpu_affinity_enabled()) {
+        int cpus = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        if (!Platform::set_thread_affinity(worker->id % cpus) && logger_) {
+            logger_->warn("Failed to pin worker {} to a CPU: {}", worker->id, Platform::get_last_error());
+        }
+    }
+
+    TimerWheel& timers = *worker->timers;
+
+    while (running_) {
+        // Sleep until the next tick only while deadlines are pending
+        int count = loop.wait(timers.next_timeout_ms(TimerWheel::now_ms()));
+        if (count < 0) {
+            UTC_ERROR("UTCServer", "Event loop wait failed in worker " + std::to_string(worker->id));
+            break;
+        }
+
+        // One pin per batch of events; released before the loop sleeps again
+        auto policy = policy_->pin(WORKER_READERS + static_cast<size_t>(worker->id));
+
+        for (int i = 0; i < count && running_; ++i) {
+            void* data = loop.event_data(i);
+            if (data == &worker->listener_tag) {
+                accept_ready(worker, *policy);
+            } else if (data == &worker->udp_tag) {
+                serve_udp(worker->udp_fd, *worker->udp_batch, *policy);
+            } else if (data == &worker->ntp_tag) {
+                serve_ntp(worker->ntp_fd, *worker->ntp_batch, &worker->latency, *policy);
+            } else {
+                connection_ready(worker, static_cast<UTCConnection*>(data), loop.event_flags(i));
+            }
+        }
+
+        // Reap everything that missed its deadline; event pointers above are no longer used
+        timers.advance(TimerWheel::now_ms(), [this, worker, &policy](TimerWheel::Timer& timer) {
+            if (timer.data == &worker->listener_tag) {
+                accept_ready(worker, *policy);
+            } else {
+                expire_connection(worker, static_cast<UTCConnection*>(timer.data));
+            }
+        });
+    }
+
+    // Drop whatever is still in flight on this worker
+    timers.cancel(worker->accept_retry);
+    for (auto& entry : worker->connections) {
+        timers.cancel(entry.second->deadline());
+    }
+    stats_->add(Counter::CONNECTIONS_CLOSED, worker->connections.size());
+    worker->connections.clear();
+}
+
+void UTCServer::uring_main(Worker* worker) {
+    UringLoop& ring = *worker->ring;
+
+    if (config_->is_cpu_affinity_enabled()) {
+        int cpus = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        if (!Platform::set_thread_affinity(worker->id % cpus) && logger_) {
+            logger_->warn("Failed to pin worker {} to a CPU: {}", worker->id, Platform::get_last_error());
+        }
+    }
+
+    // Keep serving until shutdown, then until every queued write and close has run
+    uint64_t drain_deadline = 0;
+    while (running_ || worker->in_flight > 0) {
+        // Bounded wait so stop() is noticed without a wakeup channel
+        int count = ring.wait(running_ ? 200 : 10);
+        if (count < 0) {
+            UTC_ERROR("UTCServer", "io_uring wait failed in worker " + std::to_string(worker->id));
+            break;
+        }
+        if (!running_) {
+            // A quiet wait does not mean the ring is empty; only give up on it after a while
+            uint64_t now_ms = TimerWheel::now_ms();
+            if (drain_deadline == 0) {
+                drain_deadline = now_ms + URING_DRAIN_MS;
+            } else if (count == 0 && now_ms >= drain_deadline) {
+                if (logger_) {
+                    logger_->warn("Worker {} gave up on {} unfinished io_uring writes at shutdown",
+                                 worker->id, worker->in_flight);
+                }
+                break;
+            }
+        }
+
+        auto policy = policy_->pin(WORKER_READERS + static_cast<size_t>(worker->id));
+
+        for (int i = 0; i < count; ++i) {
+            const UringLoop::Completion& completion = ring.completion(i);
+            switch (completion.user_data & URING_KIND_MASK) {
+                case URING_ACCEPT:
+                    if (completion.result >= 0) {
+                        uring_accepted(worker, completion.result, *policy);
+                    } else if (completion.result != -ECONNABORTED && completion.result != -EINTR) {
+                        stats_->add(Counter::ACCEPT_FAILED);
+                        UTC_ERROR("UTCServer", "Failed to accept connection: " +
+                                  std::string(strerror(-completion.result)));
+                    }
+                    // The kernel ends a multishot accept on errors and overflow; put it back
+                    if (!UringLoop::has_more(completion.flags) && running_ &&
+                        !ring.accept_multishot(worker->listen_fd, URING_ACCEPT)) {
+                        UTC_ERROR("UTCServer", "Failed to re-arm accept in worker " + std::to_string(worker->id));
+                    }
+                    break;
+
+                case URING_WRITE:
+                    worker->in_flight--;
+                    stats_->add(Counter::CONNECTIONS_CLOSED);
+                    if (completion.result == static_cast<int32_t>(UTCPacket::PACKET_SIZE)) {
+                        stats_->add(Counter::PACKETS_SENT);
+                        if (detailed_stats_) {
+                            uint64_t accepted = completion.user_data >> URING_KIND_BITS;
+                            worker->latency[static_cast<size_t>(LatencyMetric::ACCEPT_TO_SEND)].record(
+                                LatencyHistogram::now_ns() - accepted);
+                        }
+                    } else if (logger_) {
+                        logger_->debug("Failed to send UTC time on worker {}: {}", worker->id,
+                                      completion.result < 0 ? strerror(-completion.result) : "short write");
+                    }
+                    break;
+
+                case URING_CLOSE:
+                    // Only failures post a completion; the descriptor is gone either way
+                    UTC_ERROR("UTCServer", "Failed to close connection: " + std::string(strerror(-completion.result)));
+                    break;
+            }
+        }
+    }
+}
+
+void UTCServer::uring_accepted(Worker* worker, int client_fd, const Policy& policy) {
+    // The peer address costs a syscall, so it is only fetched when something filters on it
+    if (policy.filtered()) {
+        struct sockaddr_storage client_addr;
+        socklen_t length = sizeof(client_addr);
+        if (getpeername(client_fd, reinterpret_cast<struct sockaddr*>(&client_addr), &length) != 0) {
+            Platform::close_socket(client_fd);
+            return;
+        }
+        if (!policy.access_control->is_allowed(client_addr)) {
+            Platform::close_socket(client_fd);
+            worker->rejected.fetch_add(1, std::memory_order_relaxed);
+            stats_->add(Counter::CONNECTIONS_DENIED);
+            return;
+        }
+        if (policy.rate_limiter && !policy.rate_limiter->allow(client_addr)) {
+            Platform::close_socket(client_fd);
+            worker->rejected.fetch_add(1, std::memory_order_relaxed);
+            stats_->add(Counter::CONNECTIONS_REJECTED);
+            return;
+        }
+    }
+
+    if (!running_ || worker->in_flight >= worker->max_connections) {
+        Platform::close_socket(client_fd);
+        worker->rejected.fetch_add(1, std::memory_order_relaxed);
+        stats_->add(Counter::CONNECTIONS_REJECTED);
+        return;
+    }
+
+    const uint8_t* reply = worker->reply_for(get_utc_timestamp());
+
+    uint64_t accepted = detailed_stats_ ? LatencyHistogram::now_ns() : 0;
+    if (!worker->ring->write_fixed_and_close(client_fd, reply, UTCPacket::PACKET_SIZE,
+                                             (accepted << URING_KIND_BITS) | URING_WRITE, URING_CLOSE)) {
+        UTC_ERROR("UTCServer", "io_uring submission queue full in worker " + std::to_string(worker->id));
+        Platform::close_socket(client_fd);
+        worker->rejected.fetch_add(1, std::memory_order_relaxed);
+        stats_->add(Counter::CONNECTIONS_REJECTED);
+        return;
+    }
+
+    worker->in_flight++;
+    stats_->add(Counter::CONNECTIONS_ACCEPTED);
+    worker->accepted.fetch_add(1, std::memory_order_relaxed);
+}
+
+void UTCServer::accept_ready(Worker* worker, const Policy& policy) {
+    int timeout_ms = policy.connection_timeout;
+    uint64_t now_ms = timeout_ms > 0 ? TimerWheel::now_ms() : 0;
+
+    // Edge-triggered: drain the backlog until the kernel reports EAGAIN
+    while (running_) {
+        struct sockaddr_storage client_addr;
+        int client_fd = Platform::accept_nonblocking(worker->listen_fd, &client_addr);
+
+        if (client_fd < 0) {
+            if (Platform::would_block()) {
+                break;
+            }
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            stats_->add(Counter::ACCEPT_FAILED);
+            if ((errno == EMFILE || errno == ENFILE) && shed_connection(worker)) {
+                continue;
+            }
+
+            // No new edge arrives for connections already queued, so the listener is polled again
+            if (!worker->accept_retry.is_armed()) {
+                UTC_ERROR("UTCServer", "Failed to accept connection: " + Platform::get_last_error());
+                worker->timers->schedule(worker->accept_retry, ACCEPT_RETRY_MS, TimerWheel::now_ms());
+            }
+            break;
+        }
+
+        // Filter before any per-connection state exists
+        if (!policy.access_control->is_allowed(client_addr)) {
+            Platform::close_socket(client_fd);
+            worker->rejected.fetch_add(1, std::memory_order_relaxed);
+            stats_->add(Counter::CONNECTIONS_DENIED);
+            continue;
+        }
+        if (policy.rate_limiter && !policy.rate_limiter->allow(client_addr)) {
+            Platform::close_socket(client_fd);
+            worker->rejected.fetch_add(1, std::memory_order_relaxed);
+            stats_->add(Counter::CONNECTIONS_REJECTED);
+            continue;
+        }
+
+        // Each worker enforces its share of the limit on its own connection table
+        if (worker->connections.size() >= worker->max_connections) {
+            if (logger_) {
+                logger_->warn("Connection limit reached, rejecting connection from {}", client_addr);
+            }
+            Platform::close_socket(client_fd);
+            worker->rejected.fetch_add(1, std::memory_order_relaxed);
+            stats_->add(Counter::CONNECTIONS_REJECTED);
+            continue;
+        }
+
+        uint64_t accepted = detailed_stats_ ? LatencyHistogram::now_ns() : 0;
+
+        // Fast path: reply before any per-connection state exists, and close unless waiting for the client
+        if (reply_on_accept_) {
+            AcceptReply result = reply_on_accept(client_fd, worker->reply_for(get_utc_timestamp()), accepted,
+                                                 detailed_stats_ ? &worker->latency : nullptr);
+            if (result == AcceptReply::FAILED ||
+                (result == AcceptReply::SENT && close_strategy_ != CloseStrategy::GRACEFUL)) {
+                Platform::close_socket(client_fd);
+                stats_->add(Counter::CONNECTIONS_ACCEPTED);
+                stats_->add(Counter::CONNECTIONS_CLOSED);
+                worker->accepted.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            if (result == AcceptReply::SENT) {
+                ConnectionPtr connection = make_connection(worker->pool.get(), client_fd, client_addr);
+                UTCConnection* waiting = connection.get();
+                worker->connections.emplace(client_fd, std::move(connection));
+                stats_->add(Counter::CONNECTIONS_ACCEPTED);
+                worker->accepted.fetch_add(1, std::memory_order_relaxed);
+                begin_close_wait(worker, waiting, false);
+                continue;
+            }
+        }
+
+        ConnectionPtr connection = make_connection(worker->pool.get(), client_fd, client_addr);
+        if (detailed_stats_) {
+            connection->set_accept_time(accepted);
+        }
+
+        // A fresh socket is writable immediately; the reply goes out from that event
+        if (!worker->loop->add(client_fd, EventLoop::EVENT_WRITABLE, connection.get())) {
+            UTC_ERROR("UTCServer", "Failed to register connection from " + Platform::address_to_string(client_addr));
+            continue;
+        }
+        // Armed from accept: a peer that never lets the reply out is reaped by the wheel
+        if (timeout_ms > 0) {
+            connection->deadline().data = connection.get();
+            worker->timers->schedule(connection->deadline(), static_cast<uint32_t>(timeout_ms), now_ms);
+        }
+        worker->connections.emplace(client_fd, std::move(connection));
+
+        stats_->add(Counter::CONNECTIONS_ACCEPTED);
+        worker->accepted.fetch_add(1, std::memory_order_relaxed);
+
+        if (logger_) {
+            logger_->debug("Accepted connection from {} on worker {} (active: {})",
+                          client_addr, worker->id, worker->connections.size());
+        }
+    }
+}
+
+void UTCServer::connection_ready(Worker* worker, UTCConnection* connection, uint32_t events) {
+    // Graceful close: the reply is out and we are waiting for the client's FIN
+    if (connection->is_close_waiting()) {
+        if ((events & (EventLoop::EVENT_ERROR | EventLoop::EVENT_HANGUP)) || connection->peer_closed()) {
+            release_connection(worker, connection);
+        }
+        return;
+    }
+
+    if ((events & EventLoop::EVENT_WRITABLE) &&
+        !(events & (EventLoop::EVENT_ERROR | EventLoop::EVENT_HANGUP))) {
+        LatencySet* latency = nullptr;
+        if (detailed_stats_) {
+            latency = &worker->latency;
+            uint64_t waited = LatencyHistogram::now_ns() - connection->get_accept_time();
+            worker->latency[static_cast<size_t>(LatencyMetric::QUEUE_WAIT)].record(waited);
+        }
+        if (send_time(connection, latency) && close_strategy_ == CloseStrategy::GRACEFUL) {
+            begin_close_wait(worker, connection, true);
+            return;
+        }
+    }
+
+    // UTC protocol is one-shot: the connection is finished either way
+    release_connection(worker, connection);
+}
+
+void UTCServer::begin_close_wait(Worker* worker, UTCConnection* connection, bool registered) {
+    // Let the client close first so TIME_WAIT lands on its side, bounded by close_wait_timeout
+    connection->start_close_wait();
+    int fd = connection->get_socket_fd();
+    bool watched = registered
+        ? worker->loop->modify(fd, EventLoop::EVENT_READABLE, connection)
+        : worker->loop->add(fd, EventLoop::EVENT_READABLE, connection);
+    if (!watched) {
+        release_connection(worker, connection);
+        return;
+    }
+    worker->timers->cancel(connection->deadline());
+    connection->deadline().data = connection;
+    worker->timers->schedule(connection->deadline(),
+                             static_cast<uint32_t>(std::max(1, config_->get_close_wait_timeout())),
+                             TimerWheel::now_ms());
+}
+
+void UTCServer::expire_connection(Worker* worker, UTCConnection* connection) {
+    // A client that never closes after its reply is not a timed-out request
+    if (connection->is_close_waiting()) {
+        release_connection(worker, connection);
+        return;
+    }
+
+    worker->timed_out.fetch_add(1, std::memory_order_relaxed);
+    stats_->add(Counter::CONNECTIONS_TIMED_OUT);
+
+    if (logger_) {
+        logger_->debug("Connection from {} timed out on worker {}",
+                      connection->get_peer(), worker->id);
+    }
+    release_connection(worker, connection);
+}
+
+bool UTCServer::shed_connection(Worker* worker) {
+    // Out of descriptors: free the reserve to accept the oldest pending connection and drop it
+    if (worker->reserve_fd < 0) {
+        return false;
+    }
+    close(worker->reserve_fd);
+    int client_fd = accept(worker->listen_fd, nullptr, nullptr);
+    if (client_fd >= 0) {
+        Platform::close_socket(client_fd);
+        worker->rejected.fetch_add(1, std::memory_order_relaxed);
+        stats_->add(Counter::CONNECTIONS_REJECTED);
+    }
+    worker->reserve_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    return client_fd >= 0;
+}
+
+void UTCServer::release_connection(Worker* worker, UTCConnection* connection) {
+    worker->timers->cancel(connection->deadline());
+
+    // Closing the descriptor also removes it from the epoll set
+    int fd = connection->get_socket_fd();
+    connection->close_connection();
+    worker->connections.erase(fd);
+    stats_->add(Counter::CONNECTIONS_CLOSED);
+}
+
+UTCServer::AcceptReply UTCServer::reply_on_accept(int client_fd, const uint8_t* reply, uint64_t accept_ns,
+                                                  LatencySet* latency) {
+    // A fresh socket's send buffer is empty, so four bytes go out without ever blocking
+    uint64_t send_start = latency ? LatencyHistogram::now_ns() : 0;
+    ssize_t sent = send(client_fd, reply, UTCPacket::PACKET_SIZE, MSG_DONTWAIT);
+    if (sent == static_cast<ssize_t>(UTCPacket::PACKET_SIZE)) {
+        stats_->add(Counter::PACKETS_SENT);
+        if (latency) {
+            uint64_t now = LatencyHistogram::now_ns();
+            (*latency)[static_cast<size_t>(LatencyMetric::SEND_SYSCALL)].record(now - send_start);
+            (*latency)[static_cast<size_t>(LatencyMetric::ACCEPT_TO_SEND)].record(now - accept_ns);
+        }
+        return AcceptReply::SENT;
+    }
+
+    // Nothing written yet: the regular path retries once the socket is writable
+    if (sent < 0 && Platform::would_block()) {
+        return AcceptReply::DEFERRED;
+    }
+    if (logger_) {
+        logger_->debug("Failed to send UTC time on accept: {}",
+                      sent < 0 ? strerror(errno) : "short write");
+    }
+    return AcceptReply::FAILED;
+}
+
+bool UTCServer::send_time(UTCConnection* connection, LatencySet* latency) {
     UTCPacket packet(get_utc_timestamp());
 
+    uint64_t send_start = latency ? LatencyHistogram::now_ns() : 0;
     if (connection->send_packet(packet)) {
-        packets_sent_++;
+        stats_->add(Counter::PACKETS_SENT);
 
-        if (logger_) {
-            logger_->debug("Sent UTC time to {}: {}",
-                          connection->get_client_address(), packet.to_string());
+        if (latency) {
+            uint64_t sent = LatencyHistogram::now_ns();
+            (*latency)[static_cast<size_t>(LatencyMetric::SEND_SYSCALL)].record(sent - send_start);
+            (*latency)[static_cast<size_t>(LatencyMetric::ACCEPT_TO_SEND)].record(sent - connection->get_accept_time());
         }
-    } else {
+
         if (logger_) {
-            logger_->warn("Failed to send UTC time to {}", connection->get_client_address());
+            logger_->debug("Sent UTC time to {}: timestamp={}",
+                          connection->get_peer(), packet.get_timestamp());
         }
+        return true;
     }
 
-    // Close connection after sending (UTC protocol is typically one-shot)
-    connection->close_connection();
+    if (logger_) {
+        logger_->warn("Failed to send UTC time to {}", connection->get_peer());
+    }
+    return false;
+}
 
-    // Remove from connections list
-    {
-        std::lock_guard<std::mutex> lock(connections_mutex_);
-        auto it = std::find_if(connections_.begin(), connections_.end(),
-                              [&connection](const std::unique_ptr<UTCConnection>& conn) {
-                                  return conn.get() == connection.get();
-                              });
-        if (it != connections_.end()) {
-            connections_.erase(it);
+void UTCServer::udp_thread_main(LatencySet* latency) {
+    UDPBatch batch(config_->get_udp_batch_size(), config_->get_max_packet_size(), kernel_timestamps_);
+    UDPBatch ntp_batch(config_->get_udp_batch_size(), config_->get_max_packet_size(), kernel_timestamps_);
+
+    // A closed socket (-1) is ignored by poll()
+    struct pollfd pfds[2];
+    pfds[0].fd = udp_socket_;
+    pfds[1].fd = ntp_socket_;
+
+    while (running_) {
+        for (auto& pfd : pfds) {
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+        }
+
+        // Bounded wait so stop() is noticed without closing the sockets under us
+        if (poll(pfds, 2, 200) > 0) {
+            auto policy = policy_->pin(UDP_READER);
+            if (pfds[0].revents) {
+                serve_udp(udp_socket_, batch, *policy);
+            }
+            // POLLERR here is transmit stamps waiting on the error queue
+            if (pfds[1].revents) {
+                serve_ntp(ntp_socket_, ntp_batch, latency, *policy);
+            }
+        }
+    }
+}
+
+void UTCServer::serve_udp(int socket_fd, UDPBatch& batch, const Policy& policy) {
+    while (running_) {
+        int count = batch.receive(socket_fd);
+        if (count < 0) {
+            UTC_ERROR("UTCServer", "Failed to receive datagrams: " + Platform::get_last_error());
+            break;
+        }
+        if (count == 0) {
+            break;
+        }
+
+        // One time-cell read and one encoding serve the whole batch
+        const TimeSource& time = TimeSource::instance();
+        std::array<uint8_t, 4> reply = time.current_reply();
+        uint32_t served = UTCPacket::load_be32(reply.data());
+        int64_t offset = time.offset_ns();
+        uint64_t now = policy.rate_limiter ? RateLimiter::now_ns() : 0;
+
+        // Reply seconds in queue order, up to the last kernel-stamped one
+        thread_local std::vector<uint32_t> stamped;
+        stamped.clear();
+        for (int i = 0; i < count; ++i) {
+            if (!admit_datagram(policy, batch.peer(i), now)) {
+                continue;
+            }
+            // With a kernel stamp, answer with the second the request arrived in, over the request
+            int64_t stamp = batch.receive_time_ns(i);
+            if (stamp) {
+                uint32_t seconds = static_cast<uint32_t>((stamp + offset) / 1000000000);
+                uint8_t* packet = batch.mutable_data(i);
+                UTCPacket::store_be32(seconds, packet);
+                batch.add_reply(i, packet, reply.size());
+                stamped.resize(batch.reply_count() - 1, served);
+                stamped.push_back(seconds);
+            } else {
+                batch.add_reply(i, reply.data(), reply.size());
+            }
+        }
+
+        // A stamp far ahead of the served second (a bogus kernel stamp, or the offset stepped
+        // back by hours) must not go out as a future time; such replies fall back to the cell
+        if (!stamped.empty() && UTCPacket::validate_many(stamped.data(), stamped.size(), served) != stamped.size()) {
+            for (size_t r = 0; r < stamped.size(); ++r) {
+                if (!UTCPacket::validate_timestamp(stamped[r], served)) {
+                    memcpy(batch.reply_data(r), reply.data(), reply.size());
+                }
+            }
+        }
+        int sent = batch.send_replies(socket_fd);
+
+        stats_->add(Counter::PACKETS_RECEIVED, static_cast<uint64_t>(count));
+        stats_->add(Counter::PACKETS_SENT, static_cast<uint64_t>(sent));
+
+        // A short batch means the socket queue is drained
+        if (static_cast<size_t>(count) < batch.capacity()) {
+            break;
         }
     }
+}
 
-    active_connections_--;
+bool UTCServer::admit_datagram(const Policy& policy, const struct sockaddr_storage& peer, uint64_t now_ns) {
+    if (!policy.access_control->is_allowed(peer)) {
+        stats_->add(Counter::CONNECTIONS_DENIED);
+        return false;
+    }
+    // Over-rate sources get silence, which is what blunts reflection
+    return !policy.rate_limiter || policy.rate_limiter->allow(peer, now_ns);
 }
 
-void UTCServer::worker_thread_main() {
+void UTCServer::serve_ntp(int socket_fd, UDPBatch& batch, LatencySet* latency, const Policy& policy) {
+    const TimeSource& time = TimeSource::instance();
+
     while (running_) {
-        std::unique_ptr<UTCConnection> connection;
+        int count = batch.receive(socket_fd);
+        if (count < 0) {
+            UTC_ERROR("UTCServer", "Failed to receive NTP datagrams: " + Platform::get_last_error());
+            break;
+        }
+        if (count == 0) {
+            break;
+        }
 
-        // Get next connection to handle
-        {
-            std::lock_guard<std::mutex> lock(connections_mutex_);
-            if (!connections_.empty()) {
-                connection = std::move(connections_.front());
-                connections_.erase(connections_.begin());
+        // Kernel stamps are on the system clock; served time adds the sync offset
+        int64_t offset = time.offset_ns();
+        int64_t received = wall_ns();
+        NTPResponder::Header header = ntp_responder_->header(received + offset);
+
+        uint64_t now = policy.rate_limiter ? RateLimiter::now_ns() : 0;
+        for (int i = 0; i < count; ++i) {
+            if (!admit_datagram(policy, batch.peer(i), now)) {
+                continue;
+            }
+            int64_t stamp = batch.receive_time_ns(i);
+            uint8_t* packet = batch.mutable_data(i);
+            if (ntp_responder_->respond(header, packet, batch.size(i), (stamp ? stamp : received) + offset)) {
+                batch.add_reply(i, packet, NTPPacket::PACKET_SIZE);
             }
         }
 
-        if (connection) {
-            handle_connection(std::move(connection));
-        } else {
-            // No connections to handle, sleep briefly
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        // One clock read stamps the whole batch as late as possible
+        int64_t transmit = wall_ns() + offset;
+        for (size_t r = 0; r < batch.reply_count(); ++r) {
+            NTPResponder::set_transmit_time(batch.reply_data(r), transmit);
+        }
+        int sent = batch.send_replies(socket_fd);
+
+        stats_->add(Counter::PACKETS_RECEIVED, static_cast<uint64_t>(count));
+        stats_->add(Counter::PACKETS_SENT, static_cast<uint64_t>(sent));
+
+        if (static_cast<size_t>(count) < batch.capacity()) {
+            break;
         }
     }
+
+    if (tx_timestamps_) {
+        collect_transmit_timestamps(socket_fd, latency);
+    }
+}
+
+void UTCServer::collect_transmit_timestamps(int socket_fd, LatencySet* latency) {
+    LatencyHistogram& residence = (*latency)[static_cast<size_t>(LatencyMetric::NTP_RESIDENCE)];
+    int64_t offset = TimeSource::instance().offset_ns();
+
+    // The looped-back frame ends with our reply, whose receive field is the kernel arrival stamp
+    uint8_t frame[2048];
+    Platform::read_transmit_timestamps(socket_fd, frame, sizeof(frame),
+        [&residence, offset](const uint8_t* data, size_t size, int64_t sent_ns) {
+            if (size < NTPPacket::PACKET_SIZE) {
+                return;
+            }
+            const uint8_t* reply = data + size - NTPPacket::PACKET_SIZE;
+            int64_t received = NTPPacket::from_timestamp(
+                NTPPacket::load_be64(reply + NTPPacket::OFFSET_RECEIVE_TIME)) - offset;
+            if (sent_ns >= received) {
+                residence.record(static_cast<uint64_t>(sent_ns - received));
+            }
+        });
 }
 
 bool UTCServer::create_server_socket() {
+    server_socket_ = open_listener(false);
+    return server_socket_ >= 0;
+}
+
+int UTCServer::open_socket(int type, int port, struct sockaddr_storage& address, size_t& length) {
+    const std::string& listen_address = config_->get_listen_address();
+    if (!Platform::resolve_address(listen_address, port, config_->is_ipv6_enabled(), address, length)) {
+        return -1;
+    }
+
+    int fd = Platform::create_socket(address.ss_family, type, 0);
+
+    // A host without IPv6 still serves IPv4 on the wildcard address
+    if (fd < 0 && address.ss_family == AF_INET6 &&
+        Platform::resolve_address(listen_address, port, false, address, length)) {
+        if (logger_) {
+            logger_->warn("IPv6 not available, listening on IPv4 only");
+        }
+        fd = Platform::create_socket(address.ss_family, type, 0);
+    }
+    if (fd < 0) {
+        return -1;
+    }
+
+    // One socket per port for both families; IPv4 peers arrive as ::ffff:a.b.c.d
+    if (address.ss_family == AF_INET6 && !Platform::set_dual_stack(fd) && logger_) {
+        logger_->warn("Failed to enable dual-stack IPv6: {}", Platform::get_last_error());
+    }
+    return fd;
+}
+
+int UTCServer::open_listener(bool reuse_port) {
     // Create socket
-    server_socket_ = Platform::create_socket(AF_INET, SOCK_STREAM, 0);
-    if (server_socket_ < 0) {
+    struct sockaddr_storage address;
+    size_t length;
+    int fd = open_socket(SOCK_STREAM, config_->get_listen_port(), address, length);
+    if (fd < 0) {
         UTC_ERROR("UTCServer", "Failed to create server socket: " + Platform::get_last_error());
-        return false;
+        return -1;
     }
 
     // Set socket options
     int reuse = 1;
-    if (!Platform::set_socket_option(server_socket_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse))) {
+    if (!Platform::set_socket_option(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse))) {
         if (logger_) {
             logger_->warn("Failed to set SO_REUSEADDR: {}", Platform::get_last_error());
         }
     }
 
+#ifdef SO_REUSEPORT
+    if (reuse_port && !Platform::set_socket_option(fd, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(reuse))) {
+        UTC_ERROR("UTCServer", "Failed to set SO_REUSEPORT: " + Platform::get_last_error());
+        Platform::close_socket(fd);
+        return -1;
+    }
+#endif
+
+    // Accepted sockets inherit the buffer sizes; set before listen() so the window scale matches
+    set_socket_buffers(fd);
+
+    // Accepted sockets inherit the linger setting, so close() resets instead of entering TIME_WAIT
+    if (config_->get_close_strategy() == CloseStrategy::ABORTIVE) {
+        struct linger abort_linger;
+        abort_linger.l_onoff = 1;
+        abort_linger.l_linger = 0;
+        if (!Platform::set_socket_option(fd, SOL_SOCKET, SO_LINGER, &abort_linger, sizeof(abort_linger)) && logger_) {
+            logger_->warn("Failed to set SO_LINGER for abortive close: {}", Platform::get_last_error());
+        }
+    }
+
     // Bind socket
-    if (!Platform::bind_socket(server_socket_, config_->get_listen_address(), config_->get_listen_port())) {
+    if (!Platform::bind_socket(fd, address, length)) {
         UTC_ERROR("UTCServer", "Failed to bind socket: " + Platform::get_last_error());
-        Platform::close_socket(server_socket_);
-        server_socket_ = -1;
-        return false;
+        Platform::close_socket(fd);
+        return -1;
     }
 
-    // Listen for connections
-    if (!Platform::listen_socket(server_socket_, config_->get_max_connections())) {
+#ifdef TCP_FASTOPEN
+    // Returning clients that present a cookie are accepted on their SYN, a round trip sooner
+    if (config_->is_tcp_fastopen_enabled()) {
+        int queue = std::max(1, config_->get_tcp_fastopen_queue_size());
+        if (!Platform::set_socket_option(fd, IPPROTO_TCP, TCP_FASTOPEN, &queue, sizeof(queue)) && logger_) {
+            logger_->warn("Failed to enable TCP Fast Open: {}", Platform::get_last_error());
+        }
+    }
+#endif
+
+    // Listen for connections; the backlog defaults to the connection limit
+    int backlog = config_->get_listen_backlog() > 0 ? config_->get_listen_backlog() : config_->get_max_connections();
+    if (!Platform::listen_socket(fd, backlog)) {
         UTC_ERROR("UTCServer", "Failed to listen on socket: " + Platform::get_last_error());
-        Platform::close_socket(server_socket_);
-        server_socket_ = -1;
-        return false;
+        Platform::close_socket(fd);
+        return -1;
     }
 
-    return true;
+    // Shard listeners are only ever used by the event loop backend
+    if (reuse_port && !Platform::set_nonblocking(fd)) {
+        UTC_ERROR("UTCServer", "Failed to make listener non-blocking: " + Platform::get_last_error());
+        Platform::close_socket(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+int UTCServer::open_udp_socket(int port, bool reuse_port, bool transmit_timestamps) {
+    struct sockaddr_storage address;
+    size_t length;
+    int fd = open_socket(SOCK_DGRAM, port, address, length);
+    if (fd < 0) {
+        UTC_ERROR("UTCServer", "Failed to create UDP socket: " + Platform::get_last_error());
+        return -1;
+    }
+
+    int reuse = 1;
+#ifdef SO_REUSEPORT
+    if (reuse_port && !Platform::set_socket_option(fd, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(reuse))) {
+        UTC_ERROR("UTCServer", "Failed to set SO_REUSEPORT on UDP socket: " + Platform::get_last_error());
+        Platform::close_socket(fd);
+        return -1;
+    }
+#else
+    (void)reuse;
+#endif
+
+    set_socket_buffers(fd);
+
+    // Without kernel stamps the arrival time falls back to one clock read per batch
+    if (kernel_timestamps_ && !Platform::enable_timestamping(fd, true, transmit_timestamps)) {
+        if (logger_) {
+            logger_->warn("Failed to enable kernel {} timestamps: {}",
+                          transmit_timestamps ? "transmit" : "receive", Platform::get_last_error());
+        }
+        if (transmit_timestamps) {
+            Platform::enable_timestamping(fd, true, false);
+        }
+    }
+
+    if (!Platform::bind_socket(fd, address, length)) {
+        UTC_ERROR("UTCServer", "Failed to bind UDP socket to port " + std::to_string(port) + ": " +
+                  Platform::get_last_error());
+        Platform::close_socket(fd);
+        return -1;
+    }
+
+    if (!Platform::set_nonblocking(fd)) {
+        UTC_ERROR("UTCServer", "Failed to make UDP socket non-blocking: " + Platform::get_last_error());
+        Platform::close_socket(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+void UTCServer::set_socket_buffers(int fd) {
+    int size = config_->get_socket_buffer_size();
+    if (size <= 0) {
+        return;
+    }
+    // The kernel doubles the value for bookkeeping and caps it at net.core.[rw]mem_max
+    if ((!Platform::set_socket_option(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size)) ||
+         !Platform::set_socket_option(fd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size))) && logger_) {
+        logger_->warn("Failed to set socket buffers to {} bytes: {}", size, Platform::get_last_error());
+    }
 }
 
 void UTCServer::close_server_socket() {
@@ -283,20 +1700,25 @@ void UTCServer::close_server_socket() {
         Platform::close_socket(server_socket_);
         server_socket_ = -1;
     }
+    if (udp_socket_ >= 0) {
+        Platform::close_socket(udp_socket_);
+        udp_socket_ = -1;
+    }
+    if (ntp_socket_ >= 0) {
+        Platform::close_socket(ntp_socket_);
+        ntp_socket_ = -1;
+    }
 }
 
 uint32_t UTCServer::get_utc_timestamp() {
-    return UTCPacket::get_current_utc_timestamp();
+    return TimeSource::instance().now_seconds();
 }
 
 void UTCServer::update_reference_time() {
-    // This would typically synchronize with upstream time servers
-    // For now, we just use the system time
-    // In a full implementation, this would:
-    // 1. Query upstream NTP servers
-    // 2. Calculate time offset
-    // 3. Apply drift compensation
-    // 4. Update local time reference
+    // The sync thread does the network work; this only moves its next round forward
+    if (synchronizer_) {
+        synchronizer_->request_poll();
+    }
 }
 
 } // namespace simple_utcd
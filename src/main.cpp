@@ -4,12 +4,65 @@
 #include <chrono>
 #include <csignal>
 #include "simple_utcd/utc_server.hpp"
+#include "simple_utcd/admin_server.hpp"
 #include "simple_utcd/utc_config.hpp"
 #include "simple_utcd/logger.hpp"
 #include "simple_utcd/error_handler.hpp"
 
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+namespace {
+
+const char* const CONFIG_FILE = "config/simple-utcd.conf";
+
+// Set by the handlers, acted on by the main loop
+volatile std::sig_atomic_t stop_requested = 0;
+volatile std::sig_atomic_t reload_requested = 0;
+
+void on_stop(int) {
+    stop_requested = 1;
+}
+
+void on_reload(int) {
+    reload_requested = 1;
+}
+
+// A file that fails to parse leaves the running policy in place
+void reload_configuration(simple_utcd::UTCServer& server, simple_utcd::Logger& logger) {
+    logger.info("Reloading configuration from {}", CONFIG_FILE);
+    simple_utcd::UTCConfig next;
+    try {
+        if (!next.load(CONFIG_FILE)) {
+            logger.error("Failed to reload configuration file; keeping the current configuration");
+            return;
+        }
+    } catch (const std::exception& e) {
+        logger.error("Failed to reload configuration file: {}; keeping the current configuration", e.what());
+        return;
+    }
+
+    if (server.reload(next)) {
+        logger.set_level(simple_utcd::Logger::parse_level(next.get_log_level()));
+    }
+}
+
+} // namespace
+
 int main(int argc, char* argv[]) {
     try {
+#ifndef _WIN32
+        // Blocked before any thread exists, so every thread inherits the mask and only
+        // the main thread, which unblocks them below, ever runs the handlers
+        sigset_t control_signals;
+        sigemptyset(&control_signals);
+        sigaddset(&control_signals, SIGINT);
+        sigaddset(&control_signals, SIGTERM);
+        sigaddset(&control_signals, SIGHUP);
+        pthread_sigmask(SIG_BLOCK, &control_signals, nullptr);
+#endif
+
         // Initialize error handler
         simple_utcd::ErrorHandlerManager::initialize_default();
 
@@ -19,37 +72,71 @@ int main(int argc, char* argv[]) {
 
         // Load configuration
         auto config = std::make_unique<simple_utcd::UTCConfig>();
-        if (!config->load("config/simple-utcd.conf")) {
+        if (!config->load(CONFIG_FILE)) {
             logger->error("Failed to load configuration file");
             return 1;
         }
 
+        // Apply logging settings
+        logger->set_level(simple_utcd::Logger::parse_level(config->get_log_level()));
+        if (config->is_async_logging_enabled()) {
+            logger->enable_async(static_cast<size_t>(config->get_log_queue_size()),
+                                 config->get_log_flush_interval(),
+                                 static_cast<size_t>(config->get_log_flush_size()),
+                                 simple_utcd::Logger::parse_overflow_policy(config->get_log_overflow_policy()));
+        }
+
         // Create and start UTC server
         auto server = std::make_unique<simple_utcd::UTCServer>(config.get(), logger.get());
 
         logger->info("UTC Daemon initialized successfully");
         logger->info("Listening on {}:{}", config->get_listen_address(), config->get_listen_port());
 
+#ifndef _WIN32
+        // A peer that resets before its reply is written must not take the daemon down
+        signal(SIGPIPE, SIG_IGN);
+#endif
+
         // Start the server
         if (!server->start()) {
             logger->error("Failed to start UTC server");
             return 1;
         }
 
+        // Optional HTTP admin endpoint; monitoring problems never stop serving
+        std::unique_ptr<simple_utcd::AdminServer> admin;
+        if (config->get_admin_port() > 0) {
+            admin = std::make_unique<simple_utcd::AdminServer>(server.get(), config.get(), logger.get());
+            if (!admin->start()) {
+                logger->warn("Admin endpoint disabled: could not listen on {}:{}",
+                             config->get_admin_address(), config->get_admin_port());
+            }
+        }
+
         // Keep the server running
-        logger->info("UTC Daemon is running. Press Ctrl+C to stop.");
+        logger->info("UTC Daemon is running. Press Ctrl+C to stop, send SIGHUP to reload.");
 
-        // Simple signal handling for graceful shutdown
-        signal(SIGINT, [](int) {
-            // This will be handled by the server's stop method
-            exit(0);
-        });
+        signal(SIGINT, on_stop);
+        signal(SIGTERM, on_stop);
+#ifndef _WIN32
+        signal(SIGHUP, on_reload);
+        pthread_sigmask(SIG_UNBLOCK, &control_signals, nullptr);
+#endif
 
         // Keep the main thread alive
-        while (server->is_running()) {
-            std::this_thread::sleep_for(std::chrono::seconds(1));
+        while (server->is_running() && !stop_requested) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            if (reload_requested) {
+                reload_requested = 0;
+                reload_configuration(*server, *logger);
+            }
         }
 
+        // Stop taking new work, then let the server drain and join its threads
+        logger->info("Shutting down UTC Daemon");
+        admin.reset();
+        server->stop();
+
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;
@@ -0,0 +1,117 @@
+/*
+ * src/tests/test_connection_close.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simple_utcd/utc_connection.hpp"
+#include "simple_utcd/utc_packet.hpp"
+#include <arpa/inet.h>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace simple_utcd;
+
+namespace {
+
+constexpr int CONNECTIONS = 200;
+
+size_t open_fds() {
+    size_t count = 0;
+    if (DIR* dir = opendir("/proc/self/fd")) {
+        while (readdir(dir)) {
+            ++count;
+        }
+        closedir(dir);
+    }
+    return count;
+}
+
+// Accepts one connection whose client has already reset it
+int accept_reset_peer(int listener, const struct sockaddr_in& address, struct sockaddr_storage& peer) {
+    int client = socket(AF_INET, SOCK_STREAM, 0);
+    if (client < 0 || connect(client, reinterpret_cast<const struct sockaddr*>(&address), sizeof(address)) != 0) {
+        return -1;
+    }
+    socklen_t length = sizeof(peer);
+    int fd = accept(listener, reinterpret_cast<struct sockaddr*>(&peer), &length);
+
+    // SO_LINGER {1, 0} turns close() into a reset
+    struct linger linger = {1, 0};
+    setsockopt(client, SOL_SOCKET, SO_LINGER, &linger, sizeof(linger));
+    close(client);
+
+    struct pollfd pfd = {fd, POLLIN, 0};
+    poll(&pfd, 1, 1000);
+    return fd;
+}
+
+} // namespace
+
+int main() {
+    // The reply to a reset peer would raise SIGPIPE; the daemon ignores it too
+    signal(SIGPIPE, SIG_IGN);
+
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    if (listener < 0 || bind(listener, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listener, 16) != 0 ||
+        getsockname(listener, reinterpret_cast<struct sockaddr*>(&address), &length) != 0) {
+        std::perror("listener");
+        return 1;
+    }
+
+    size_t before = open_fds();
+    int failed_sends = 0;
+    for (int i = 0; i < CONNECTIONS; ++i) {
+        struct sockaddr_storage peer;
+        int fd = accept_reset_peer(listener, address, peer);
+        if (fd < 0) {
+            std::perror("accept");
+            return 1;
+        }
+
+        UTCConnection connection(fd, peer, nullptr, nullptr);
+        if (!connection.send_packet(UTCPacket(1))) {
+            failed_sends++;
+        }
+        // The serving paths close explicitly and then drop the record
+        connection.close_connection();
+    }
+    size_t after = open_fds();
+
+    if (failed_sends == 0) {
+        std::fprintf(stderr, "FAIL: no send to a reset peer failed, the test did not exercise anything\n");
+        return 1;
+    }
+    if (after != before) {
+        std::fprintf(stderr, "FAIL: %zu descriptors before, %zu after %d connections (%d failed sends)\n",
+                     before, after, CONNECTIONS, failed_sends);
+        return 1;
+    }
+    std::printf("PASS: %d connections, %d failed sends, no descriptors leaked\n", CONNECTIONS, failed_sends);
+    close(listener);
+    return 0;
+}
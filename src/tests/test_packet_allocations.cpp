@@ -0,0 +1,130 @@
+/*
+ * src/tests/test_packet_allocations.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simple_utcd/utc_connection.hpp"
+#include "simple_utcd/utc_packet.hpp"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <sys/socket.h>
+
+// Every heap allocation in the process goes through these
+namespace {
+std::atomic<size_t> allocations{0};
+}
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    std::free(p);
+}
+
+using namespace simple_utcd;
+
+namespace {
+
+constexpr int REQUESTS = 1000000;
+
+// One request as the serving path sees it: encode, send, receive, decode
+bool serve_one(UTCConnection& server, UTCConnection& client, uint32_t timestamp) {
+    UTCPacket reply(timestamp);
+    std::array<uint8_t, UTCPacket::PACKET_SIZE> bytes = reply.to_array();
+
+    UTCPacket decoded(0);
+    if (!decoded.decode_from(bytes.data(), bytes.size()) || decoded.get_timestamp() != timestamp) {
+        std::fprintf(stderr, "decode_from returned a different timestamp\n");
+        return false;
+    }
+
+    UTCPacket received(0);
+    if (!server.send_packet(reply) || !client.receive_packet(received)) {
+        std::fprintf(stderr, "send_packet/receive_packet failed\n");
+        return false;
+    }
+    if (received.get_timestamp() != timestamp) {
+        std::fprintf(stderr, "received %u, sent %u\n", received.get_timestamp(), timestamp);
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        std::perror("socketpair");
+        return 1;
+    }
+
+    struct sockaddr_storage peer;
+    std::memset(&peer, 0, sizeof(peer));
+    peer.ss_family = AF_UNIX;
+
+    bool ok = true;
+    size_t counted = 0;
+    {
+        // No config and no logger, as in a server with debug logging off
+        UTCConnection server(fds[0], peer, nullptr, nullptr);
+        UTCConnection client(fds[1], peer, nullptr, nullptr);
+
+        // Any one-time setup, such as the time source singleton, happens here
+        uint32_t now = UTCPacket::get_current_utc_timestamp();
+        ok = serve_one(server, client, now);
+
+        size_t before = allocations.load(std::memory_order_relaxed);
+        for (int i = 0; ok && i < REQUESTS; ++i) {
+            ok = serve_one(server, client, now - static_cast<uint32_t>(i % 60));
+        }
+        counted = allocations.load(std::memory_order_relaxed) - before;
+    }
+
+    if (!ok) {
+        return 1;
+    }
+    if (counted != 0) {
+        std::fprintf(stderr, "FAIL: %zu heap allocations across %d requests\n", counted, REQUESTS);
+        return 1;
+    }
+    std::printf("PASS: 0 heap allocations across %d requests\n", REQUESTS);
+    return 0;
+}
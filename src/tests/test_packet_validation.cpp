@@ -0,0 +1,85 @@
+/*
+ * src/tests/test_packet_validation.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simple_utcd/utc_packet.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+using namespace simple_utcd;
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        std::fprintf(stderr, "FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+// validate_many must agree entry for entry with validate_timestamp
+void check_against_scalar(const std::vector<uint32_t>& timestamps, uint32_t now, const char* what) {
+    std::unique_ptr<bool[]> results(new bool[timestamps.size()]);
+    size_t valid = UTCPacket::validate_many(timestamps.data(), timestamps.size(), now, results.get());
+
+    size_t expected = 0;
+    bool agrees = true;
+    for (size_t i = 0; i < timestamps.size(); ++i) {
+        bool ok = UTCPacket::validate_timestamp(timestamps[i], now);
+        expected += ok;
+        agrees = agrees && results[i] == ok;
+    }
+    check(valid == expected && agrees, what);
+    check(UTCPacket::validate_many(timestamps.data(), timestamps.size(), now) == expected, what);
+}
+
+} // namespace
+
+int main() {
+    const uint32_t now = 3900000000u;
+    const uint32_t tolerance = UTCPacket::FUTURE_TOLERANCE;
+
+    std::vector<uint32_t> edges = {0, 1, now - 1, now, now + 1, now + tolerance - 1, now + tolerance,
+                                   now + tolerance + 1, UINT32_MAX};
+    check_against_scalar(edges, now, "boundaries around now + FUTURE_TOLERANCE");
+    check(UTCPacket::validate_many(edges.data(), edges.size(), now) == 7, "two timestamps past the tolerance");
+
+    // Near the top of the range the limit saturates instead of wrapping to a small value
+    std::vector<uint32_t> top = {UINT32_MAX - 1, UINT32_MAX, 0};
+    check_against_scalar(top, UINT32_MAX - tolerance / 2, "limit saturates at the end of the 32-bit range");
+    check(UTCPacket::validate_many(top.data(), top.size(), UINT32_MAX - tolerance / 2) == top.size(),
+          "everything is within tolerance near the end of the range");
+
+    // Long enough for the vectorized loop body and its remainder
+    std::vector<uint32_t> sweep;
+    for (uint32_t i = 0; i < 1003; ++i) {
+        sweep.push_back(now - 500 + i * 7);
+    }
+    check_against_scalar(sweep, now, "sweep across the tolerance boundary");
+
+    check(UTCPacket::validate_many(nullptr, 0, now) == 0, "empty block");
+
+    if (failures > 0) {
+        return 1;
+    }
+    std::printf("PASS: validate_many matches validate_timestamp\n");
+    return 0;
+}
@@ -0,0 +1,268 @@
+/*
+ * src/tests/test_time_sync.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simple_utcd/time_synchronizer.hpp"
+#include "simple_utcd/ntp_packet.hpp"
+#include "simple_utcd/utc_config.hpp"
+#include "simple_utcd/utc_packet.hpp"
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace simple_utcd;
+
+namespace {
+
+constexpr int64_t MS = 1000000;
+constexpr int64_t NS_PER_SECOND = 1000000000;
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        std::fprintf(stderr, "FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+int64_t wall_ns() {
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
+// A server reply to a request sent with transmit timestamp @p origin
+void make_reply(uint8_t* reply, uint64_t origin, int64_t t2_ns, int64_t t3_ns, uint8_t stratum = 2) {
+    std::memset(reply, 0, NTPPacket::PACKET_SIZE);
+    reply[NTPPacket::OFFSET_FLAGS] = NTPPacket::make_flags(NTPPacket::LEAP_NONE, 4, NTPPacket::MODE_SERVER);
+    reply[NTPPacket::OFFSET_STRATUM] = stratum;
+    NTPPacket::store_be64(origin, reply + NTPPacket::OFFSET_ORIGIN_TIME);
+    NTPPacket::store_be64(NTPPacket::to_timestamp(t2_ns), reply + NTPPacket::OFFSET_RECEIVE_TIME);
+    NTPPacket::store_be64(NTPPacket::to_timestamp(t3_ns), reply + NTPPacket::OFFSET_TRANSMIT_TIME);
+}
+
+/**
+ * @brief Loopback upstream that answers as a time server running @p offset_ns ahead
+ */
+class StandIn {
+public:
+    enum class Kind { SNTP, SNTP_KISS_OF_DEATH, SNTP_WRONG_ORIGIN, TIME_TCP, TIME_TCP_UNIX_EPOCH };
+
+    StandIn(Kind kind, int64_t offset_ns) : kind_(kind), offset_ns_(offset_ns), stop_(false) {
+        bool stream = kind == Kind::TIME_TCP || kind == Kind::TIME_TCP_UNIX_EPOCH;
+        fd_ = socket(AF_INET, stream ? SOCK_STREAM : SOCK_DGRAM, 0);
+
+        struct sockaddr_in address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(address);
+        if (fd_ < 0 || bind(fd_, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0 ||
+            (stream && listen(fd_, 16) != 0) ||
+            getsockname(fd_, reinterpret_cast<struct sockaddr*>(&address), &length) != 0) {
+            std::perror("stand-in");
+            std::exit(1);
+        }
+        port_ = ntohs(address.sin_port);
+        thread_ = std::thread(stream ? &StandIn::serve_stream : &StandIn::serve_datagram, this);
+    }
+
+    ~StandIn() {
+        stop_ = true;
+        thread_.join();
+        close(fd_);
+    }
+
+    std::string spec() const {
+        bool stream = kind_ == Kind::TIME_TCP || kind_ == Kind::TIME_TCP_UNIX_EPOCH;
+        return std::string(stream ? "time://" : "ntp://") + "127.0.0.1:" + std::to_string(port_);
+    }
+
+private:
+    Kind kind_;
+    int64_t offset_ns_;
+    std::atomic<bool> stop_;
+    int fd_;
+    int port_;
+    std::thread thread_;
+
+    bool wait_readable() {
+        struct pollfd pfd = {fd_, POLLIN, 0};
+        return poll(&pfd, 1, 20) > 0;
+    }
+
+    void serve_datagram() {
+        while (!stop_) {
+            if (!wait_readable()) {
+                continue;
+            }
+            uint8_t request[NTPPacket::PACKET_SIZE];
+            struct sockaddr_storage peer;
+            socklen_t length = sizeof(peer);
+            auto received = recvfrom(fd_, request, sizeof(request), 0, reinterpret_cast<struct sockaddr*>(&peer), &length);
+            if (received != static_cast<ssize_t>(sizeof(request))) {
+                continue;
+            }
+
+            int64_t now = wall_ns() + offset_ns_;
+            uint64_t origin = NTPPacket::load_be64(request + NTPPacket::OFFSET_TRANSMIT_TIME);
+            uint8_t reply[NTPPacket::PACKET_SIZE];
+            if (kind_ == Kind::SNTP_KISS_OF_DEATH) {
+                // Stratum 0 with a kiss code in the reference ID
+                make_reply(reply, origin, now, now, 0);
+                std::memcpy(reply + NTPPacket::OFFSET_REFERENCE_ID, "RATE", 4);
+            } else {
+                make_reply(reply, kind_ == Kind::SNTP_WRONG_ORIGIN ? origin + 1 : origin, now, now);
+            }
+            sendto(fd_, reply, sizeof(reply), 0, reinterpret_cast<struct sockaddr*>(&peer), length);
+        }
+    }
+
+    void serve_stream() {
+        while (!stop_) {
+            if (!wait_readable()) {
+                continue;
+            }
+            int client = accept(fd_, nullptr, nullptr);
+            if (client < 0) {
+                continue;
+            }
+            int64_t seconds = (wall_ns() + offset_ns_) / NS_PER_SECOND;
+            if (kind_ == Kind::TIME_TCP) {
+                seconds += NTPPacket::EPOCH_DELTA;
+            }
+            uint8_t reply[4];
+            UTCPacket::store_be32(static_cast<uint32_t>(seconds), reply);
+            send(client, reply, sizeof(reply), MSG_NOSIGNAL);
+            close(client);
+        }
+    }
+};
+
+void test_sntp_sample() {
+    // 40 ms each way, 2 ms in the server, server 250 ms ahead
+    int64_t t1 = 1700000000LL * NS_PER_SECOND;
+    int64_t t2 = t1 + 40 * MS + 250 * MS;
+    int64_t t3 = t2 + 2 * MS;
+    int64_t t4 = t1 + 82 * MS;
+    uint64_t origin = NTPPacket::to_timestamp(t1);
+
+    uint8_t reply[NTPPacket::PACKET_SIZE];
+    make_reply(reply, origin, t2, t3);
+    TimeSample sample;
+    check(TimeSynchronizer::sntp_sample(reply, sizeof(reply), origin, t1, t4, sample), "valid SNTP reply accepted");
+    // NTP timestamps carry 2^-32 s, so allow a few nanoseconds of rounding
+    check(std::llabs(sample.offset_ns - 250 * MS) < 10, "SNTP offset is ((t2 - t1) + (t3 - t4)) / 2");
+    check(std::llabs(sample.delay_ns - 80 * MS) < 10, "SNTP delay excludes the server's own time");
+
+    check(!TimeSynchronizer::sntp_sample(reply, sizeof(reply), origin + 1, t1, t4, sample),
+          "reply whose origin does not echo our transmit time is rejected");
+    check(!TimeSynchronizer::sntp_sample(reply, sizeof(reply) - 1, origin, t1, t4, sample), "short reply is rejected");
+
+    make_reply(reply, origin, t2, t3, 0);
+    std::memcpy(reply + NTPPacket::OFFSET_REFERENCE_ID, "DENY", 4);
+    check(!TimeSynchronizer::sntp_sample(reply, sizeof(reply), origin, t1, t4, sample), "kiss-o'-death is rejected");
+
+    make_reply(reply, origin, t2, t3);
+    reply[NTPPacket::OFFSET_FLAGS] = NTPPacket::make_flags(NTPPacket::LEAP_ALARM, 4, NTPPacket::MODE_SERVER);
+    check(!TimeSynchronizer::sntp_sample(reply, sizeof(reply), origin, t1, t4, sample),
+          "unsynchronized server is rejected");
+}
+
+void test_rfc868_sample() {
+    int64_t t1 = 1700000000LL * NS_PER_SECOND + 100 * MS;
+    int64_t t4 = t1 + 20 * MS;
+    uint8_t reply[4];
+    UTCPacket::store_be32(static_cast<uint32_t>(1700000010LL + NTPPacket::EPOCH_DELTA), reply);
+
+    TimeSample sample;
+    check(TimeSynchronizer::rfc868_sample(reply, sizeof(reply), t1, t4, sample), "valid RFC 868 reply accepted");
+    // The middle of second ...010 against a local midpoint of ...000.110
+    check(sample.offset_ns == 10 * NS_PER_SECOND + 500 * MS - 110 * MS, "RFC 868 offset assumes mid-second");
+    check(sample.delay_ns == 20 * MS, "RFC 868 delay is the whole round trip");
+    check(sample.error_ns == 500 * MS, "RFC 868 error is half its resolution");
+}
+
+void test_sntp_median() {
+    StandIn slow(StandIn::Kind::SNTP, 200 * MS);
+    StandIn middle(StandIn::Kind::SNTP, 300 * MS);
+    StandIn fast(StandIn::Kind::SNTP, 10 * NS_PER_SECOND);
+    StandIn kiss(StandIn::Kind::SNTP_KISS_OF_DEATH, 0);
+    StandIn spoofed(StandIn::Kind::SNTP_WRONG_ORIGIN, 0);
+
+    UTCConfig config;
+    config.set_upstream_servers({slow.spec(), middle.spec(), fast.spec(), kiss.spec(), spoofed.spec()});
+    config.set_timeout(500);
+    TimeSynchronizer synchronizer(&config, nullptr);
+
+    size_t answered = synchronizer.poll_once();
+    check(answered == 3, "kiss-o'-death and wrong-origin replies are not counted as answers");
+    check(synchronizer.is_synchronized(), "SNTP stand-ins synchronize");
+    check(std::llabs(synchronizer.get_offset_ns() - 300 * MS) < 5 * MS, "estimate is the median of the votes");
+}
+
+void test_rfc868_stand_in() {
+    StandIn upstream(StandIn::Kind::TIME_TCP, 30 * NS_PER_SECOND);
+
+    UTCConfig config;
+    config.set_upstream_servers({upstream.spec()});
+    config.set_timeout(500);
+    TimeSynchronizer synchronizer(&config, nullptr);
+
+    check(synchronizer.poll_once() == 1, "RFC 868 stand-in answers");
+    check(std::llabs(synchronizer.get_offset_ns() - 30 * NS_PER_SECOND) <= NS_PER_SECOND,
+          "RFC 868 estimate is within its one-second resolution");
+}
+
+void test_max_step() {
+    // Another daemon answering RFC 868 from the Unix epoch is decades off
+    StandIn upstream(StandIn::Kind::TIME_TCP_UNIX_EPOCH, 0);
+
+    UTCConfig config;
+    config.set_upstream_servers({upstream.spec()});
+    config.set_timeout(500);
+    TimeSynchronizer synchronizer(&config, nullptr);
+
+    synchronizer.poll_once();
+    check(!synchronizer.is_synchronized() && synchronizer.get_offset_ns() == 0, "step beyond max_step is refused");
+}
+
+} // namespace
+
+int main() {
+    test_sntp_sample();
+    test_rfc868_sample();
+    test_sntp_median();
+    test_rfc868_stand_in();
+    test_max_step();
+
+    if (failures > 0) {
+        return 1;
+    }
+    std::printf("PASS: sample math, rejection rules, median and max_step against loopback stand-ins\n");
+    return 0;
+}